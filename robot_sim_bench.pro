@@ -0,0 +1,15 @@
+TEMPLATE = app
+TARGET = robot_sim_bench
+CONFIG += c++17 console release
+CONFIG -= app_bundle debug
+QT = core
+
+INCLUDEPATH += ./src \
+               /usr/include/x86_64-linux-gnu/qt5
+
+# The simulation core without the GUI entry point.
+SOURCES += $$files(src/code/*.cpp) \
+           src/bench/main.cpp
+SOURCES -= src/code/main.cpp
+
+HEADERS += src/code/*.h
@@ -0,0 +1,15 @@
+TEMPLATE = app
+TARGET = robot_sim_generate
+CONFIG += c++17 console
+CONFIG -= app_bundle
+QT = core
+
+INCLUDEPATH += ./src \
+               /usr/include/x86_64-linux-gnu/qt5
+
+# The simulation core without the GUI entry point.
+SOURCES += $$files(src/code/*.cpp) \
+           src/generate/main.cpp
+SOURCES -= src/code/main.cpp
+
+HEADERS += src/code/*.h
@@ -0,0 +1,292 @@
+/**
+ * @file main.cpp
+ * @brief Benchmark of the simulation core on synthetic scenes of increasing size.
+ *
+ * Every scene size is built from scratch at the same density, so the numbers show how each stage scales with the
+ * number of robots rather than with crowding. Sensing, the swept collision query, movement and whole engine ticks
+ * are timed separately, the latter on every requested thread count.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "code/Environment.h"
+#include "code/SimulationEngine.h"
+#include "code/AutonomousRobot.h"
+#include "algorithm"
+#include "chrono"
+#include "cmath"
+#include "cstdlib"
+#include "cstring"
+#include "iomanip"
+#include "iostream"
+#include "numeric"
+#include "random"
+#include "sstream"
+#include "string"
+#include "thread"
+#include "vector"
+
+/**
+ * @brief Settings of a benchmark run.
+ */
+struct BenchOptions {
+    std::vector<size_t> sizes {10, 100, 1000, 10000, 100000}; ///< Robot counts to benchmark.
+    std::vector<int> threads; ///< Thread counts for Parallel ticks; empty picks powers of two up to the hardware.
+    double density = 1.0; ///< Robots per 100 x 100 units of area.
+    double obstacleRatio = 1.0; ///< Obstacles per robot.
+    double minSeconds = 0.2; ///< Minimum time spent on each measurement.
+    SensorMode sensorMode = SensorMode::Rays; ///< Sensor test of the robots.
+    unsigned seed = 1; ///< Seed of the scene layout.
+};
+
+/**
+ * @brief Prints the command-line usage of the benchmark.
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--sizes N,N,...] [--threads N,N,...] [--density D] [--obstacles R] [--min-time S] [--sensor rays|sector] [--seed N]" << std::endl
+              << "  --sizes N,...    Robot counts to benchmark (default 10,100,1000,10000,100000)." << std::endl
+              << "  --threads N,...  Thread counts for parallel ticks (default powers of two up to all hardware threads)." << std::endl
+              << "  --density D      Robots per 100 x 100 units of area (default 1)." << std::endl
+              << "  --obstacles R    Obstacles per robot (default 1)." << std::endl
+              << "  --min-time S     Seconds spent on each measurement at least (default 0.2)." << std::endl
+              << "  --sensor MODE    Sensor test of the robots: rays (default) or sector." << std::endl
+              << "  --seed N         Seed of the scene layout (default 1)." << std::endl;
+}
+
+/**
+ * @brief Parses a comma-separated list of positive integers.
+ * @param text The list.
+ * @param values Receives the integers.
+ * @return False if an entry is not a positive integer.
+ */
+template <typename T>
+static bool parseList(const char* text, std::vector<T>& values) {
+    values.clear();
+    std::stringstream list(text);
+    std::string entry;
+    while (std::getline(list, entry, ',')) {
+        char* end = nullptr;
+        long value = std::strtol(entry.c_str(), &end, 10);
+        if (entry.empty() || *end != '\0' || value <= 0) {
+            return false;
+        }
+        values.push_back(static_cast<T>(value));
+    }
+    return !values.empty();
+}
+
+/**
+ * @brief Fills an environment with robots and obstacles at a fixed density.
+ * @param environment Empty environment; its size is set to fit the scene.
+ * @param robots Number of robots.
+ * @param options Density, obstacle ratio, sensor mode and seed.
+ *
+ * The area grows with the robot count, so every size has the same density. It is cut into a square grid with one
+ * cell per entity, and every entity gets a cell of its own at random, jittered inside the cell. Nothing overlaps
+ * as long as a cell is wide enough for a robot.
+ */
+static void buildScene(Environment& environment, size_t robots, const BenchOptions& options) {
+    size_t obstacles = static_cast<size_t>(std::llround(static_cast<double>(robots) * options.obstacleRatio));
+    double side = 100.0 * std::sqrt(static_cast<double>(robots) / options.density);
+    auto cellsPerSide = static_cast<size_t>(std::ceil(std::sqrt(static_cast<double>(robots + obstacles))));
+    double cell = side / static_cast<double>(cellsPerSide);
+    if (cell < 24.0) {
+        std::cerr << "warning: cells of " << cell << " units are narrower than a robot; robots may start overlapping" << std::endl;
+    }
+    environment.width = side;
+    environment.height = side;
+
+    std::mt19937 random(options.seed);
+    std::vector<size_t> cells(cellsPerSide * cellsPerSide);
+    std::iota(cells.begin(), cells.end(), size_t(0));
+    std::shuffle(cells.begin(), cells.end(), random);
+    std::uniform_real_distribution<double> unit(-1.0, 1.0);
+    std::uniform_real_distribution<double> heading(0.0, 360.0);
+    auto centre = [&](size_t index, double jitter) {
+        double x = (static_cast<double>(cells[index] % cellsPerSide) + 0.5) * cell + unit(random) * jitter;
+        double y = (static_cast<double>(cells[index] / cellsPerSide) + 0.5) * cell + unit(random) * jitter;
+        return std::make_pair(x, y);
+    };
+
+    double robotJitter = std::max(0.0, cell / 2 - 12.0);
+    for (size_t i = 0; i < robots; ++i) {
+        auto robot = std::make_unique<AutonomousRobot>(static_cast<int>(i), centre(i, robotJitter), 2.0, heading(random), 40.0, side, side, &environment);
+        robot->setSensorMode(options.sensorMode);
+        environment.addRobot(std::move(robot));
+    }
+
+    double size = std::clamp(cell * 0.5, 4.0, 40.0);
+    double obstacleJitter = std::max(0.0, (cell - size) / 2 - 1.0);
+    for (size_t i = 0; i < obstacles; ++i) {
+        environment.addObstacle(std::make_unique<Obstacle>(static_cast<int>(i), centre(robots + i, obstacleJitter), size));
+    }
+
+    environment.rebuildObstacleTree();
+    environment.updateSpatialIndex();
+}
+
+/**
+ * @brief Runs a pass over all robots repeatedly and measures the average time of one pass.
+ * @param pass The pass.
+ * @param minSeconds Time to spend at least; at least three passes are timed either way.
+ * @return Seconds per pass.
+ */
+template <typename Pass>
+static double timePass(Pass&& pass, double minSeconds) {
+    pass();  /// Warm caches and lazily built indices.
+    long passes = 0;
+    auto begin = std::chrono::steady_clock::now();
+    double elapsed = 0.0;
+    do {
+        pass();
+        ++passes;
+        elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    } while (elapsed < minSeconds || passes < 3);
+    return elapsed / static_cast<double>(passes);
+}
+
+/**
+ * @brief Prints one result line.
+ * @param environment Benchmarked environment.
+ * @param benchmark Name of the measured stage.
+ * @param threads Threads used, or 0 for a stage that always runs on one thread.
+ * @param secondsPerPass Time of one pass over all robots.
+ * @param baseline Time of the same pass on one thread, for the speedup column; 0 leaves the column empty.
+ */
+static void report(Environment& environment, const char* benchmark, int threads, double secondsPerPass, double baseline) {
+    size_t robots = environment.getRobots().size();
+    std::cout << std::setw(8) << robots << std::setw(10) << environment.getObstacles().size()
+              << std::setw(10) << std::llround(environment.width) << "  " << std::left << std::setw(12) << benchmark << std::right
+              << std::setw(8) << (threads > 0 ? std::to_string(threads) : "-")
+              << std::setw(12) << std::fixed << std::setprecision(1) << secondsPerPass * 1e9 / static_cast<double>(robots)
+              << std::setw(9);
+    if (baseline > 0) {
+        std::cout << std::setprecision(2) << baseline / secondsPerPass;
+    } else {
+        std::cout << "-";
+    }
+    std::cout << std::defaultfloat << std::endl;
+}
+
+/**
+ * @brief Benchmarks every stage on one scene size.
+ * @param robots Number of robots.
+ * @param options Benchmark settings.
+ */
+static void benchmarkSize(size_t robots, const BenchOptions& options) {
+    Environment environment;
+    buildScene(environment, robots, options);
+    RobotStore& store = environment.getRobotStore();
+    double width = environment.width;
+    double height = environment.height;
+
+    /// Sensing alone: detectObstacle changes nothing, so every pass sees the same scene.
+    volatile size_t detections = 0;
+    double detect = timePass([&] {
+        size_t found = 0;
+        for (uint32_t slot : store.autonomousSlots) {
+            found += static_cast<AutonomousRobot*>(store.handles[slot])->detectObstacle(width, height);
+        }
+        detections = detections + found;
+    }, options.minSeconds);
+    report(environment, "detect", 0, detect, 0);
+
+    /// The swept collision query that replaced canMoveTo, for the full move of every robot along x and y.
+    volatile double reachable = 0.0;
+    double sweep = timePass([&] {
+        double sum = 0.0;
+        for (size_t slot = 0; slot < store.size(); ++slot) {
+            double radians = store.headings[slot] * M_PI / 180.0;
+            double dx = store.speeds[slot] * std::cos(radians);
+            double dy = store.speeds[slot] * std::sin(radians);
+            sum += environment.sweepRobot(store.ids[slot], store.x[slot], store.y[slot], dx, 0.0, 10.0);
+            sum += environment.sweepRobot(store.ids[slot], store.x[slot], store.y[slot], 0.0, dy, 10.0);
+        }
+        reachable = reachable + sum;
+    }, options.minSeconds);
+    report(environment, "sweep", 0, sweep, 0);
+
+    /// Movement alone, that is tryMove through its public wrapper; robots do move, so the index is kept current.
+    double advance = timePass([&] {
+        environment.updateSpatialIndex();
+        for (uint32_t slot : store.autonomousSlots) {
+            static_cast<AutonomousRobot*>(store.handles[slot])->advance(width, height);
+        }
+    }, options.minSeconds);
+    report(environment, "advance", 0, advance, 0);
+
+    /// Whole ticks as SimulationEngine::update runs them, without its wall-clock pacing.
+    SimulationEngine engine(&environment);
+    engine.setUpdateMode(UpdateMode::Sequential);
+    report(environment, "step-seq", 1, timePass([&] { engine.step(); }, options.minSeconds), 0);
+
+    double baseline = 0.0;
+    for (int threads : options.threads) {
+        engine.setUpdateMode(UpdateMode::Parallel, threads);
+        double tick = timePass([&] { engine.step(); }, options.minSeconds);
+        if (baseline == 0.0) {
+            baseline = threads == 1 ? tick : 0.0;
+        }
+        report(environment, "step-par", threads, tick, baseline);
+    }
+}
+
+/**
+ * @brief Main function of the benchmark.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return Zero on success, non-zero on invalid arguments.
+ */
+int main(int argc, char *argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        bool valid = true;
+        if (std::strcmp(argv[i], "--sizes") == 0 && i + 1 < argc) {
+            valid = parseList(argv[++i], options.sizes);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            valid = parseList(argv[++i], options.threads);
+        } else if (std::strcmp(argv[i], "--density") == 0 && i + 1 < argc) {
+            options.density = std::strtod(argv[++i], nullptr);
+            valid = options.density > 0;
+        } else if (std::strcmp(argv[i], "--obstacles") == 0 && i + 1 < argc) {
+            options.obstacleRatio = std::strtod(argv[++i], nullptr);
+            valid = options.obstacleRatio >= 0;
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            options.minSeconds = std::strtod(argv[++i], nullptr);
+            valid = options.minSeconds >= 0;
+        } else if (std::strcmp(argv[i], "--sensor") == 0 && i + 1 < argc) {
+            std::string mode = argv[++i];
+            valid = mode == "rays" || mode == "sector";
+            options.sensorMode = mode == "sector" ? SensorMode::Sector : SensorMode::Rays;
+        } else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options.seed = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (options.threads.empty()) {
+        int hardware = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+        for (int threads = 1; threads < hardware; threads *= 2) {
+            options.threads.push_back(threads);
+        }
+        options.threads.push_back(hardware);
+    }
+
+    std::cout << "# density " << options.density << " robots per 100x100, " << options.obstacleRatio << " obstacles per robot, "
+              << (options.sensorMode == SensorMode::Sector ? "sector" : "rays") << " sensors" << std::endl
+              << "# robots" << std::setw(10) << "obstacles" << std::setw(10) << "world" << "  " << std::left << std::setw(12) << "benchmark"
+              << std::right << std::setw(8) << "threads" << std::setw(12) << "ns/robot" << std::setw(9) << "speedup" << std::endl;
+    for (size_t robots : options.sizes) {
+        benchmarkSize(robots, options);
+    }
+    return 0;
+}
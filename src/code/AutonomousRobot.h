@@ -9,22 +9,35 @@
 #pragma once
 #include "Robot.h"
 #include "Environment.h"
+#include "Collision.h"
 #include <utility>
 
+/**
+ * @brief How an autonomous robot decides whether something lies inside its +-30 degree sensor field.
+ */
+enum class SensorMode {
+    Rays, ///< Cast 31 rays, one every 2 degrees; thin obstacles between two rays go unnoticed.
+    Sector ///< Test the field as one circular sector against every candidate, exactly.
+};
+
 /**
  * @brief The AutonomousRobot class represents a robot that can navigate autonomously in the simulation environment.
  *
  * The AutonomousRobot class extends the Robot base class with specific functionalities for autonomous navigation and obstacle detection.
  */
 
-class AutonomousRobot : public Robot {
+class AutonomousRobot final : public Robot {
 public:
     AutonomousRobot(int id, std::pair<double, double> position, double velocity,
                     double orientation, double sensorRange, double maxWidth, double maxHeight, Environment* env); /// Constructor for the AutonomousRobot class.
 
     void move(double maxWidth, double maxHeight) override; /// Move the robot in the simulation environment.
+    void sense(double maxWidth, double maxHeight); /// Look ahead and turn away from a detected obstacle; the first half of move.
+    void advance(double maxWidth, double maxHeight); /// Move along the current heading as far as possible; the second half of move.
     void handleCollision() override; /// Handle a collision with an obstacle.
     bool detectObstacle(double maxWidth, double maxHeight); /// Detect obstacles in the robot's path.
+    void setSensorMode(SensorMode mode) { sensorMode = mode; } /// Select how the sensor field is tested.
+    [[nodiscard]] SensorMode getSensorMode() const { return sensorMode; } /// Get how the sensor field is tested.
 
 private:
     Environment* environment; /// Pointer to the simulation environment.
@@ -33,13 +46,14 @@ private:
     double maxHeight_;
     double avoidanceAngle;
     double radius;
+    SensorMode sensorMode = SensorMode::Rays; /// How the sensor field is tested.
+    Collision::BoxBatch sensorCandidates; /// Scratch batch of inflated bounds the sensor fan is tested against.
 
     void rotate(double angle) override; /// Rotate the robot by a specified angle.
+    bool detectWithRays(const QRectF& sensorArea, double reach); /// Look for candidates along the 31 sensor rays.
+    bool detectWithSector(const QRectF& sensorArea, double reach); /// Look for candidates inside the exact sensor sector.
     void tryMove(double maxWidth, double maxHeight); /// Attempt to move the robot in the simulation environment.
     bool isEdgeWithinSensorRange(double maxWidth, double maxHeight); /// Check if the robot is near the edge of the simulation environment.
-    bool canMoveTo(double x, double y, double maxWidth, double maxHeight); /// Check if the robot can move to a specified position.
     bool checkBoundary(double x, double y, double maxWidth, double maxHeight); /// Check if the robot is within the simulation environment boundaries.
     void updatePosition(double newX, double newY, double maxWidth, double maxHeight); /// Update the robot's position in the simulation environment.
-    bool lineIntersectsRect(double x1, double y1, double x2, double y2, const QRectF& rect); /// Check if a line intersects a rectangle.
-    bool lineIntersectsLine(double x1, double y1, double x2, double y2, double x3, double y3, double x4, double y4); /// Check if two lines intersect.
 };
@@ -0,0 +1,500 @@
+/**
+ * @file Collision.cpp
+ * @brief Implements the segment-versus-box and sector tests declared in Collision.h.
+ *
+ * All segment variants use the slab method with the same arithmetic (one reciprocal per segment, then multiplications), so
+ * the scalar and vector paths agree bit for bit.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "Collision.h"
+#include "algorithm"
+#include "cmath"
+
+// GCC and Clang always build the AVX path for x86 and pick it at run time; other compilers build it only when they
+// target AVX themselves.
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define ROBOT_SIM_AVX_TARGET __attribute__((target("avx")))
+#define ROBOT_SIM_HAS_AVX() (__builtin_cpu_init(), __builtin_cpu_supports("avx"))
+#elif defined(__AVX__)
+#define ROBOT_SIM_AVX_TARGET
+#define ROBOT_SIM_HAS_AVX() true
+#endif
+
+#if defined(ROBOT_SIM_AVX_TARGET)
+#include "immintrin.h"
+#elif defined(__SSE2__)
+#include "emmintrin.h"
+#endif
+
+namespace Collision {
+
+    namespace {
+        /**
+         * @brief Squared distance from a point to a segment.
+         * @param px x-coordinate of the point.
+         * @param py y-coordinate of the point.
+         * @param ax x-coordinate of the start of the segment.
+         * @param ay y-coordinate of the start of the segment.
+         * @param bx x-coordinate of the end of the segment.
+         * @param by y-coordinate of the end of the segment.
+         * @return The squared distance.
+         */
+        double squaredDistanceToSegment(double px, double py, double ax, double ay, double bx, double by) {
+            double dx = bx - ax;
+            double dy = by - ay;
+            double lengthSquared = dx * dx + dy * dy;
+            double t = lengthSquared > 0.0 ? ((px - ax) * dx + (py - ay) * dy) / lengthSquared : 0.0;
+            t = std::max(0.0, std::min(1.0, t));
+            double ex = ax + t * dx - px;
+            double ey = ay + t * dy - py;
+            return ex * ex + ey * ey;
+        }
+
+        /**
+         * @brief Clips a convex polygon against the half-plane to the left of a line through the origin.
+         * @param xs x-coordinates of the polygon, relative to the sector apex.
+         * @param ys y-coordinates of the polygon, relative to the sector apex.
+         * @param count Number of vertices; updated to the vertex count of the clipped polygon.
+         * @param dirX x-component of the line direction.
+         * @param dirY y-component of the line direction.
+         *
+         * Points p with cross(dir, p) >= 0 are kept (one Sutherland-Hodgman pass). A convex polygon clipped by one
+         * half-plane gains at most one vertex, so the arrays need room for count + 1 entries.
+         */
+        void clipLeftOf(double* xs, double* ys, int& count, double dirX, double dirY) {
+            double outX[8];
+            double outY[8];
+            int out = 0;
+            for (int i = 0; i < count; ++i) {
+                int j = (i + 1) % count;
+                double si = dirX * ys[i] - dirY * xs[i];
+                double sj = dirX * ys[j] - dirY * xs[j];
+                if (si >= 0.0) {
+                    outX[out] = xs[i];
+                    outY[out] = ys[i];
+                    ++out;
+                }
+                if ((si >= 0.0) != (sj >= 0.0)) {
+                    double t = si / (si - sj);
+                    outX[out] = xs[i] + t * (xs[j] - xs[i]);
+                    outY[out] = ys[i] + t * (ys[j] - ys[i]);
+                    ++out;
+                }
+            }
+            std::copy(outX, outX + out, xs);
+            std::copy(outY, outY + out, ys);
+            count = out;
+        }
+    }
+
+    /**
+     * @brief Checks whether a segment crosses or touches the boundary of an axis-aligned box.
+     * @param x1 x-coordinate of the start of the segment.
+     * @param y1 y-coordinate of the start of the segment.
+     * @param x2 x-coordinate of the end of the segment.
+     * @param y2 y-coordinate of the end of the segment.
+     * @param left Left edge of the box.
+     * @param top Top edge of the box.
+     * @param right Right edge of the box.
+     * @param bottom Bottom edge of the box.
+     * @return True if any point of the segment lies inside or on the boundary of the box.
+     *
+     * The segment is clipped against the x and y slabs of the box; it touches the closed box if the remaining
+     * parameter interval is non-empty.
+     */
+    bool segmentTouchesBox(double x1, double y1, double x2, double y2,
+                           double left, double top, double right, double bottom) {
+        double tMin = 0.0;
+        double tMax = 1.0;
+        double dx = x2 - x1;
+        double dy = y2 - y1;
+        if (dx == 0.0) {
+            if (x1 < left || x1 > right) return false;
+        } else {
+            double inverse = 1.0 / dx;
+            double t1 = (left - x1) * inverse;
+            double t2 = (right - x1) * inverse;
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        if (dy == 0.0) {
+            if (y1 < top || y1 > bottom) return false;
+        } else {
+            double inverse = 1.0 / dy;
+            double t1 = (top - y1) * inverse;
+            double t2 = (bottom - y1) * inverse;
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        return tMin <= tMax;
+    }
+
+    /**
+     * @brief Checks whether a segment crosses or touches the boundary of an axis-aligned box.
+     * @param x1 x-coordinate of the start of the segment.
+     * @param y1 y-coordinate of the start of the segment.
+     * @param x2 x-coordinate of the end of the segment.
+     * @param y2 y-coordinate of the end of the segment.
+     * @param left Left edge of the box.
+     * @param top Top edge of the box.
+     * @param right Right edge of the box.
+     * @param bottom Bottom edge of the box.
+     * @return True if the segment has a point on the boundary of the box.
+     *
+     * Since the box is convex, a segment touching it misses the boundary only when both of its end points lie
+     * strictly inside.
+     */
+    bool segmentCrossesBox(double x1, double y1, double x2, double y2,
+                           double left, double top, double right, double bottom) {
+        bool startInside = x1 > left && x1 < right && y1 > top && y1 < bottom;
+        bool endInside = x2 > left && x2 < right && y2 > top && y2 < bottom;
+        if (startInside && endInside) {
+            return false;
+        }
+        return segmentTouchesBox(x1, y1, x2, y2, left, top, right, bottom);
+    }
+
+    namespace {
+#if defined(ROBOT_SIM_AVX_TARGET)
+        /**
+         * @brief Evaluates segmentCrossesBox for four consecutive boxes of a batch with AVX.
+         * @param boxes Boxes to test against.
+         * @param at Index of the first of the four boxes.
+         * @param x1 x-coordinate of the start of the segment.
+         * @param y1 y-coordinate of the start of the segment.
+         * @param x2 x-coordinate of the end of the segment.
+         * @param y2 y-coordinate of the end of the segment.
+         * @return Mask with all bits of a lane set where that box is crossed.
+         */
+        ROBOT_SIM_AVX_TARGET inline __m256d crossedBlockAvx(const BoxBatch& boxes, size_t at,
+                                                            double x1, double y1, double x2, double y2) {
+            double dx = x2 - x1;
+            double dy = y2 - y1;
+            const __m256d sx1 = _mm256_set1_pd(x1), sy1 = _mm256_set1_pd(y1);
+            const __m256d sx2 = _mm256_set1_pd(x2), sy2 = _mm256_set1_pd(y2);
+            const __m256d zero = _mm256_setzero_pd(), one = _mm256_set1_pd(1.0);
+            __m256d l = _mm256_loadu_pd(&boxes.left[at]);
+            __m256d t = _mm256_loadu_pd(&boxes.top[at]);
+            __m256d r = _mm256_loadu_pd(&boxes.right[at]);
+            __m256d b = _mm256_loadu_pd(&boxes.bottom[at]);
+
+            __m256d startInside = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(sx1, l, _CMP_GT_OQ), _mm256_cmp_pd(sx1, r, _CMP_LT_OQ)),
+                                                _mm256_and_pd(_mm256_cmp_pd(sy1, t, _CMP_GT_OQ), _mm256_cmp_pd(sy1, b, _CMP_LT_OQ)));
+            __m256d endInside = _mm256_and_pd(_mm256_and_pd(_mm256_cmp_pd(sx2, l, _CMP_GT_OQ), _mm256_cmp_pd(sx2, r, _CMP_LT_OQ)),
+                                              _mm256_and_pd(_mm256_cmp_pd(sy2, t, _CMP_GT_OQ), _mm256_cmp_pd(sy2, b, _CMP_LT_OQ)));
+            __m256d tMin = zero, tMax = one;
+            __m256d valid = _mm256_andnot_pd(_mm256_and_pd(startInside, endInside), _mm256_cmp_pd(zero, zero, _CMP_EQ_OQ));
+            if (dx == 0.0) {
+                valid = _mm256_and_pd(valid, _mm256_and_pd(_mm256_cmp_pd(sx1, l, _CMP_GE_OQ), _mm256_cmp_pd(sx1, r, _CMP_LE_OQ)));
+            } else {
+                const __m256d invX = _mm256_set1_pd(1.0 / dx);
+                __m256d t1 = _mm256_mul_pd(_mm256_sub_pd(l, sx1), invX);
+                __m256d t2 = _mm256_mul_pd(_mm256_sub_pd(r, sx1), invX);
+                tMin = _mm256_max_pd(tMin, _mm256_min_pd(t1, t2));
+                tMax = _mm256_min_pd(tMax, _mm256_max_pd(t1, t2));
+            }
+            if (dy == 0.0) {
+                valid = _mm256_and_pd(valid, _mm256_and_pd(_mm256_cmp_pd(sy1, t, _CMP_GE_OQ), _mm256_cmp_pd(sy1, b, _CMP_LE_OQ)));
+            } else {
+                const __m256d invY = _mm256_set1_pd(1.0 / dy);
+                __m256d t1 = _mm256_mul_pd(_mm256_sub_pd(t, sy1), invY);
+                __m256d t2 = _mm256_mul_pd(_mm256_sub_pd(b, sy1), invY);
+                tMin = _mm256_max_pd(tMin, _mm256_min_pd(t1, t2));
+                tMax = _mm256_min_pd(tMax, _mm256_max_pd(t1, t2));
+            }
+            return _mm256_and_pd(valid, _mm256_cmp_pd(tMin, tMax, _CMP_LE_OQ));
+        }
+
+        /**
+         * @brief Tests a segment against the boxes of a batch four at a time with AVX, eight per iteration.
+         * @param x1 x-coordinate of the start of the segment.
+         * @param y1 y-coordinate of the start of the segment.
+         * @param x2 x-coordinate of the end of the segment.
+         * @param y2 y-coordinate of the end of the segment.
+         * @param boxes Boxes to test against.
+         * @param i Index of the first box to test; left at the first box not tested.
+         * @return True as soon as one box is crossed.
+         */
+        ROBOT_SIM_AVX_TARGET bool crossesAnyAvx(double x1, double y1, double x2, double y2, const BoxBatch& boxes, size_t& i) {
+            size_t count = boxes.size();
+            for (; i + 8 <= count; i += 8) {
+                if (_mm256_movemask_pd(_mm256_or_pd(crossedBlockAvx(boxes, i, x1, y1, x2, y2),
+                                                    crossedBlockAvx(boxes, i + 4, x1, y1, x2, y2))) != 0) {
+                    return true;
+                }
+            }
+            for (; i + 4 <= count; i += 4) {
+                if (_mm256_movemask_pd(crossedBlockAvx(boxes, i, x1, y1, x2, y2)) != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+#endif
+
+#if defined(__SSE2__)
+        /**
+         * @brief Tests a segment against the boxes of a batch two at a time with SSE2, four per iteration.
+         * @param x1 x-coordinate of the start of the segment.
+         * @param y1 y-coordinate of the start of the segment.
+         * @param x2 x-coordinate of the end of the segment.
+         * @param y2 y-coordinate of the end of the segment.
+         * @param boxes Boxes to test against.
+         * @param i Index of the first box to test; left at the first box not tested.
+         * @return True as soon as one box is crossed.
+         */
+        bool crossesAnySse2(double x1, double y1, double x2, double y2, const BoxBatch& boxes, size_t& i) {
+            size_t count = boxes.size();
+            double dx = x2 - x1;
+            double dy = y2 - y1;
+            const __m128d sx1 = _mm_set1_pd(x1), sy1 = _mm_set1_pd(y1);
+            const __m128d sx2 = _mm_set1_pd(x2), sy2 = _mm_set1_pd(y2);
+            const __m128d invX = _mm_set1_pd(dx == 0.0 ? 0.0 : 1.0 / dx);
+            const __m128d invY = _mm_set1_pd(dy == 0.0 ? 0.0 : 1.0 / dy);
+            const __m128d zero = _mm_setzero_pd(), one = _mm_set1_pd(1.0);
+            auto block = [&](size_t at) {
+                __m128d l = _mm_loadu_pd(&boxes.left[at]);
+                __m128d t = _mm_loadu_pd(&boxes.top[at]);
+                __m128d r = _mm_loadu_pd(&boxes.right[at]);
+                __m128d b = _mm_loadu_pd(&boxes.bottom[at]);
+
+                __m128d startInside = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(sx1, l), _mm_cmplt_pd(sx1, r)),
+                                                 _mm_and_pd(_mm_cmpgt_pd(sy1, t), _mm_cmplt_pd(sy1, b)));
+                __m128d endInside = _mm_and_pd(_mm_and_pd(_mm_cmpgt_pd(sx2, l), _mm_cmplt_pd(sx2, r)),
+                                               _mm_and_pd(_mm_cmpgt_pd(sy2, t), _mm_cmplt_pd(sy2, b)));
+                __m128d tMin = zero, tMax = one;
+                __m128d valid = _mm_andnot_pd(_mm_and_pd(startInside, endInside), _mm_cmpeq_pd(zero, zero));
+                if (dx == 0.0) {
+                    valid = _mm_and_pd(valid, _mm_and_pd(_mm_cmpge_pd(sx1, l), _mm_cmple_pd(sx1, r)));
+                } else {
+                    __m128d t1 = _mm_mul_pd(_mm_sub_pd(l, sx1), invX);
+                    __m128d t2 = _mm_mul_pd(_mm_sub_pd(r, sx1), invX);
+                    tMin = _mm_max_pd(tMin, _mm_min_pd(t1, t2));
+                    tMax = _mm_min_pd(tMax, _mm_max_pd(t1, t2));
+                }
+                if (dy == 0.0) {
+                    valid = _mm_and_pd(valid, _mm_and_pd(_mm_cmpge_pd(sy1, t), _mm_cmple_pd(sy1, b)));
+                } else {
+                    __m128d t1 = _mm_mul_pd(_mm_sub_pd(t, sy1), invY);
+                    __m128d t2 = _mm_mul_pd(_mm_sub_pd(b, sy1), invY);
+                    tMin = _mm_max_pd(tMin, _mm_min_pd(t1, t2));
+                    tMax = _mm_min_pd(tMax, _mm_max_pd(t1, t2));
+                }
+                return _mm_and_pd(valid, _mm_cmple_pd(tMin, tMax));
+            };
+            for (; i + 4 <= count; i += 4) {
+                if (_mm_movemask_pd(_mm_or_pd(block(i), block(i + 2))) != 0) {
+                    return true;
+                }
+            }
+            for (; i + 2 <= count; i += 2) {
+                if (_mm_movemask_pd(block(i)) != 0) {
+                    return true;
+                }
+            }
+            return false;
+        }
+#endif
+    } // namespace
+
+    /**
+     * @brief Checks whether a segment crosses the boundary of any box of a batch.
+     * @param x1 x-coordinate of the start of the segment.
+     * @param y1 y-coordinate of the start of the segment.
+     * @param x2 x-coordinate of the end of the segment.
+     * @param y2 y-coordinate of the end of the segment.
+     * @param boxes Boxes to test against.
+     * @return True as soon as one box is crossed.
+     *
+     * The vector loops evaluate segmentCrossesBox for several boxes per instruction and stop at the first block
+     * that contains a hit. The AVX loop runs when the processor supports it, the SSE2 loop otherwise. Boxes left
+     * over at the end of the batch go through the scalar test.
+     */
+    bool segmentCrossesAny(double x1, double y1, double x2, double y2, const BoxBatch& boxes) {
+        size_t count = boxes.size();
+        size_t i = 0;
+
+#if defined(ROBOT_SIM_AVX_TARGET)
+        static const bool hasAvx = ROBOT_SIM_HAS_AVX();
+        if (hasAvx) {
+            if (crossesAnyAvx(x1, y1, x2, y2, boxes, i)) {
+                return true;
+            }
+        }
+#endif
+#if defined(__SSE2__)
+        if (crossesAnySse2(x1, y1, x2, y2, boxes, i)) {
+            return true;
+        }
+#endif
+
+        for (; i < count; ++i) {
+            if (segmentCrossesBox(x1, y1, x2, y2, boxes.left[i], boxes.top[i], boxes.right[i], boxes.bottom[i])) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Builds a sector from its apex, radius, heading and half-angle.
+     * @param x x-coordinate of the apex.
+     * @param y y-coordinate of the apex.
+     * @param radius Radius of the sector.
+     * @param heading Direction of the sector axis in radians.
+     * @param halfAngle Half of the opening angle in radians, at most pi / 2.
+     * @return The sector.
+     */
+    Sector makeSector(double x, double y, double radius, double heading, double halfAngle) {
+        return Sector{x, y, radius,
+                      std::cos(heading + halfAngle), std::sin(heading + halfAngle),
+                      std::cos(heading - halfAngle), std::sin(heading - halfAngle)};
+    }
+
+    /**
+     * @brief Checks whether a sector and a closed axis-aligned box share at least one point.
+     * @param sector The sector.
+     * @param left Left edge of the box.
+     * @param top Top edge of the box.
+     * @param right Right edge of the box.
+     * @param bottom Bottom edge of the box.
+     * @return True if they overlap, including when the apex lies inside the box.
+     *
+     * The box is clipped to the wedge between the two sector edges, which leaves a convex polygon of at most six
+     * vertices. The sector meets the box exactly when that polygon comes within the sector radius of the apex.
+     */
+    bool sectorTouchesBox(const Sector& sector, double left, double top, double right, double bottom) {
+        if (sector.x >= left && sector.x <= right && sector.y >= top && sector.y <= bottom) {
+            return true;
+        }
+        double nearestX = std::max(left, std::min(sector.x, right)) - sector.x;
+        double nearestY = std::max(top, std::min(sector.y, bottom)) - sector.y;
+        double radiusSquared = sector.radius * sector.radius;
+        if (nearestX * nearestX + nearestY * nearestY > radiusSquared) {
+            return false;
+        }
+
+        double xs[8] = {left - sector.x, right - sector.x, right - sector.x, left - sector.x};
+        double ys[8] = {top - sector.y, top - sector.y, bottom - sector.y, bottom - sector.y};
+        int count = 4;
+        clipLeftOf(xs, ys, count, sector.rightX, sector.rightY);
+        clipLeftOf(xs, ys, count, -sector.leftX, -sector.leftY);
+        for (int i = 0; i < count; ++i) {
+            int j = (i + 1) % count;
+            if (squaredDistanceToSegment(0.0, 0.0, xs[i], ys[i], xs[j], ys[j]) <= radiusSquared) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /**
+     * @brief Checks whether a sector and a closed disc share at least one point.
+     * @param sector The sector.
+     * @param x x-coordinate of the disc centre.
+     * @param y y-coordinate of the disc centre.
+     * @param radius Radius of the disc.
+     * @return True if they overlap.
+     *
+     * A centre inside the wedge is as far from the sector as it is beyond the arc; any other centre is nearest to
+     * one of the two straight edges.
+     */
+    bool sectorTouchesCircle(const Sector& sector, double x, double y, double radius) {
+        double dx = x - sector.x;
+        double dy = y - sector.y;
+        double reach = sector.radius + radius;
+        double distanceSquared = dx * dx + dy * dy;
+        if (distanceSquared > reach * reach) {
+            return false;
+        }
+        bool insideWedge = sector.rightX * dy - sector.rightY * dx >= 0.0 && dx * sector.leftY - dy * sector.leftX >= 0.0;
+        if (insideWedge) {
+            return true;
+        }
+        double radiusSquared = radius * radius;
+        return squaredDistanceToSegment(x, y, sector.x, sector.y, sector.x + sector.radius * sector.leftX,
+                                        sector.y + sector.radius * sector.leftY) <= radiusSquared ||
+               squaredDistanceToSegment(x, y, sector.x, sector.y, sector.x + sector.radius * sector.rightX,
+                                        sector.y + sector.radius * sector.rightY) <= radiusSquared;
+    }
+
+    /**
+     * @brief Finds when a point moving along a segment first touches a closed axis-aligned box.
+     * @param x x-coordinate of the start of the motion.
+     * @param y y-coordinate of the start of the motion.
+     * @param dx Displacement along x over the whole motion.
+     * @param dy Displacement along y over the whole motion.
+     * @param left Left edge of the box.
+     * @param top Top edge of the box.
+     * @param right Right edge of the box.
+     * @param bottom Bottom edge of the box.
+     * @return Fraction of the motion in [0, 1] at first contact, or NoImpact.
+     *
+     * The slab method gives the parameter interval [tMin, tMax] the segment spends in the box; contact happens at
+     * tMin unless the interval is empty or the motion only leaves the box.
+     */
+    double boxTimeOfImpact(double x, double y, double dx, double dy,
+                           double left, double top, double right, double bottom) {
+        if (x > left && x < right && y > top && y < bottom) {
+            return NoImpact;
+        }
+
+        double tMin = 0.0;
+        double tMax = 1.0;
+        if (dx == 0.0) {
+            if (x < left || x > right) return NoImpact;
+        } else {
+            double inverse = 1.0 / dx;
+            double t1 = (left - x) * inverse;
+            double t2 = (right - x) * inverse;
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        if (dy == 0.0) {
+            if (y < top || y > bottom) return NoImpact;
+        } else {
+            double inverse = 1.0 / dy;
+            double t1 = (top - y) * inverse;
+            double t2 = (bottom - y) * inverse;
+            tMin = std::max(tMin, std::min(t1, t2));
+            tMax = std::min(tMax, std::max(t1, t2));
+        }
+        if (tMin > tMax || tMax <= 0.0) {
+            return NoImpact;
+        }
+        return tMin;
+    }
+
+    /**
+     * @brief Finds when a point moving along a segment first touches a closed disc.
+     * @param x x-coordinate of the start of the motion.
+     * @param y y-coordinate of the start of the motion.
+     * @param dx Displacement along x over the whole motion.
+     * @param dy Displacement along y over the whole motion.
+     * @param centerX x-coordinate of the disc centre.
+     * @param centerY y-coordinate of the disc centre.
+     * @param radius Radius of the disc.
+     * @return Fraction of the motion in [0, 1] at first contact, or NoImpact.
+     *
+     * Solves |start + t * d - centre| = radius for the smaller root t.
+     */
+    double discTimeOfImpact(double x, double y, double dx, double dy, double centerX, double centerY, double radius) {
+        double ox = x - centerX;
+        double oy = y - centerY;
+        double c = ox * ox + oy * oy - radius * radius;
+        double b = ox * dx + oy * dy;
+        if (c < 0.0 || b >= 0.0) {
+            return NoImpact;
+        }
+        double a = dx * dx + dy * dy;
+        double discriminant = b * b - a * c;
+        if (discriminant < 0.0) {
+            return NoImpact;
+        }
+        double t = (-b - std::sqrt(discriminant)) / a;
+        return t <= 1.0 ? std::max(0.0, t) : NoImpact;
+    }
+}
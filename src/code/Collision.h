@@ -0,0 +1,129 @@
+/**
+ * @file Collision.h
+ * @brief Segment-versus-box tests shared by the robot sensors and movement checks.
+ *
+ * Both robot types ask the same question over and over: does the segment from the robot to some point cross the
+ * boundary of an axis-aligned box (an obstacle or another robot, grown by the robot radius)? This header provides a
+ * scalar test for single boxes and a batched kernel that tests one segment against many boxes at once, plus exact
+ * tests of a circular sensor sector against boxes and circles, and time-of-impact queries for moving robots.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef COLLISION_H
+#define COLLISION_H
+
+#include "vector"
+#include "cstddef"
+#include "limits"
+
+namespace Collision {
+
+    /**
+     * @brief Boxes stored as four separate coordinate arrays, the layout the batched kernel loads from.
+     */
+    struct BoxBatch {
+        std::vector<double> left; ///< Left edges.
+        std::vector<double> top; ///< Top edges.
+        std::vector<double> right; ///< Right edges.
+        std::vector<double> bottom; ///< Bottom edges.
+
+        void clear() { left.clear(); top.clear(); right.clear(); bottom.clear(); } ///< Removes all boxes.
+        [[nodiscard]] size_t size() const { return left.size(); } ///< Number of boxes.
+        /// Appends a box given by its edges.
+        void add(double l, double t, double r, double b) { left.push_back(l); top.push_back(t); right.push_back(r); bottom.push_back(b); }
+    };
+
+    /**
+     * @brief Checks whether a segment touches an axis-aligned box, using the slab method.
+     * @return True if any point of the segment lies inside or on the boundary of the box.
+     *
+     * This is the one scalar segment-versus-box kernel; segmentCrossesBox and ObstacleTree build on it.
+     */
+    bool segmentTouchesBox(double x1, double y1, double x2, double y2,
+                           double left, double top, double right, double bottom);
+
+    /**
+     * @brief Checks whether a segment crosses or touches the boundary of an axis-aligned box.
+     * @return True if the segment has a point on the boundary of the box.
+     *
+     * A segment lying strictly inside the box does not count, matching a test against the four edges of the box.
+     */
+    bool segmentCrossesBox(double x1, double y1, double x2, double y2,
+                           double left, double top, double right, double bottom);
+
+    /**
+     * @brief Checks whether a segment crosses the boundary of any box of a batch.
+     * @param x1 x-coordinate of the start of the segment.
+     * @param y1 y-coordinate of the start of the segment.
+     * @param x2 x-coordinate of the end of the segment.
+     * @param y2 y-coordinate of the end of the segment.
+     * @param boxes Boxes to test against.
+     * @return True as soon as one box is crossed.
+     *
+     * Uses AVX (four boxes per instruction, eight per iteration) when the processor supports it, SSE2 (two boxes per
+     * instruction, four per iteration) on other x86 processors, and segmentCrossesBox otherwise.
+     */
+    bool segmentCrossesAny(double x1, double y1, double x2, double y2, const BoxBatch& boxes);
+
+    /**
+     * @brief Circular sector (a pie slice) with its trigonometry precomputed, as swept by a robot sensor.
+     *
+     * The half-angle must not exceed 90 degrees, so the wedge between the two edges is convex.
+     */
+    struct Sector {
+        double x; ///< x-coordinate of the apex.
+        double y; ///< y-coordinate of the apex.
+        double radius; ///< Radius of the sector.
+        double leftX; ///< x-component of the unit vector along the edge at heading + half-angle.
+        double leftY; ///< y-component of the unit vector along the edge at heading + half-angle.
+        double rightX; ///< x-component of the unit vector along the edge at heading - half-angle.
+        double rightY; ///< y-component of the unit vector along the edge at heading - half-angle.
+    };
+
+    /**
+     * @brief Builds a sector from its apex, radius, heading and half-angle.
+     * @param x x-coordinate of the apex.
+     * @param y y-coordinate of the apex.
+     * @param radius Radius of the sector.
+     * @param heading Direction of the sector axis in radians.
+     * @param halfAngle Half of the opening angle in radians, at most pi / 2.
+     * @return The sector.
+     */
+    Sector makeSector(double x, double y, double radius, double heading, double halfAngle);
+
+    /**
+     * @brief Checks whether a sector and a closed axis-aligned box share at least one point.
+     * @return True if they overlap, including when the apex lies inside the box.
+     */
+    bool sectorTouchesBox(const Sector& sector, double left, double top, double right, double bottom);
+
+    /**
+     * @brief Checks whether a sector and a closed disc share at least one point.
+     * @return True if they overlap.
+     */
+    bool sectorTouchesCircle(const Sector& sector, double x, double y, double radius);
+
+    /// Time of impact reported when a moving point never makes contact.
+    constexpr double NoImpact = std::numeric_limits<double>::infinity();
+
+    /**
+     * @brief Finds when a point moving along a segment first touches a closed axis-aligned box.
+     * @return Fraction of the segment travelled at first contact, or NoImpact.
+     *
+     * A point that starts strictly inside the box, or starts on its boundary and moves away, is not stopped by it.
+     */
+    double boxTimeOfImpact(double x, double y, double dx, double dy,
+                           double left, double top, double right, double bottom);
+
+    /**
+     * @brief Finds when a point moving along a segment first touches a closed disc.
+     * @return Fraction of the segment travelled at first contact, or NoImpact.
+     *
+     * A point that starts inside the disc, or on its boundary without moving inwards, is not stopped by it.
+     */
+    double discTimeOfImpact(double x, double y, double dx, double dy, double centerX, double centerY, double radius);
+}
+
+#endif // COLLISION_H
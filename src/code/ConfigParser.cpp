@@ -0,0 +1,268 @@
+/**
+ * @file ConfigParser.cpp
+ * @brief Implements the configuration parser declared in ConfigParser.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "ConfigParser.h"
+#include "MappedFile.h"
+#include "charconv"
+#include "cstdlib"
+#include "cstring"
+#include "string_view"
+#include "thread"
+#include "algorithm"
+
+namespace {
+
+/**
+ * @brief Takes the next field of a line.
+ * @param cursor Position in the line; moved past the field.
+ * @param end End of the line.
+ * @return The field, or an empty view if the line has no more fields.
+ */
+std::string_view nextField(const char*& cursor, const char* end) {
+    while (cursor < end && (*cursor == ' ' || *cursor == '\t')) {
+        ++cursor;
+    }
+    const char* start = cursor;
+    while (cursor < end && *cursor != ' ' && *cursor != '\t') {
+        ++cursor;
+    }
+    return {start, static_cast<size_t>(cursor - start)};
+}
+
+/**
+ * @brief Converts a whole field to an integer.
+ * @param field The field.
+ * @param value Receives the integer.
+ * @return False unless the field is exactly one integer.
+ */
+bool toInt(std::string_view field, int& value) {
+    const char* begin = field.data();
+    const char* end = begin + field.size();
+    if (begin < end && *begin == '+') {
+        ++begin;
+    }
+    auto result = std::from_chars(begin, end, value);
+    return !field.empty() && result.ec == std::errc() && result.ptr == end;
+}
+
+/**
+ * @brief Converts a whole field to a floating-point number.
+ * @param field The field.
+ * @param value Receives the number.
+ * @return False unless the field is exactly one number.
+ *
+ * Standard libraries without floating-point std::from_chars fall back to strtod on a terminated copy, since the
+ * mapped file has no terminator to stop at.
+ */
+bool toDouble(std::string_view field, double& value) {
+    const char* begin = field.data();
+    const char* end = begin + field.size();
+    if (begin < end && *begin == '+') {
+        ++begin;
+    }
+    if (begin == end) {
+        return false;
+    }
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto result = std::from_chars(begin, end, value);
+    return result.ec == std::errc() && result.ptr == end;
+#else
+    char buffer[64];
+    size_t length = static_cast<size_t>(end - begin);
+    if (length >= sizeof(buffer)) {
+        return false;
+    }
+    std::memcpy(buffer, begin, length);
+    buffer[length] = '\0';
+    char* parsedEnd = nullptr;
+    value = std::strtod(buffer, &parsedEnd);
+    return parsedEnd == buffer + length;
+#endif
+}
+
+/**
+ * @brief Checks that nothing but an optional comment follows the last field.
+ * @param cursor Position after the last field.
+ * @param end End of the line.
+ * @return True if the rest of the line is blank or a comment.
+ */
+bool atLineEnd(const char* cursor, const char* end) {
+    std::string_view rest = nextField(cursor, end);
+    return rest.empty() || rest[0] == '#';
+}
+
+/**
+ * @brief Parses one line and appends what it holds to a configuration.
+ * @param begin First character of the line.
+ * @param end End of the line, without the newline.
+ * @param line Line number.
+ * @param config Configuration to append to.
+ */
+void parseLine(const char* begin, const char* end, int line, SceneConfig& config) {
+    if (begin < end && end[-1] == '\r') {
+        --end;
+    }
+    const char* cursor = begin;
+    std::string_view type = nextField(cursor, end);
+    if (type.empty() || type[0] == '#') {
+        return;
+    }
+
+    if (type == "Robot") {
+        RobotConfig robot {};
+        robot.line = line;
+        std::string_view kind = nextField(cursor, end);
+        bool known = kind == "autonomous" || kind == "remote";
+        robot.kind = kind == "remote" ? RobotKind::Remote : RobotKind::Autonomous;
+        bool valid = toInt(nextField(cursor, end), robot.id)
+                     && toDouble(nextField(cursor, end), robot.x)
+                     && toDouble(nextField(cursor, end), robot.y)
+                     && toDouble(nextField(cursor, end), robot.speed)
+                     && toDouble(nextField(cursor, end), robot.orientation)
+                     && toDouble(nextField(cursor, end), robot.sensorRange)
+                     && atLineEnd(cursor, end);
+        if (!known) {
+            config.errors.push_back({line, "Unknown robot type: " + std::string(begin, end)});
+        } else if (!valid) {
+            config.errors.push_back({line, "Failed to read Robot data: " + std::string(begin, end)});
+        } else {
+            config.robots.push_back(robot);
+        }
+    } else if (type == "Obstacle") {
+        ObstacleConfig obstacle {};
+        obstacle.line = line;
+        bool valid = toInt(nextField(cursor, end), obstacle.id)
+                     && toDouble(nextField(cursor, end), obstacle.x)
+                     && toDouble(nextField(cursor, end), obstacle.y)
+                     && toDouble(nextField(cursor, end), obstacle.size)
+                     && atLineEnd(cursor, end);
+        if (!valid) {
+            config.errors.push_back({line, "Failed to read Obstacle data: " + std::string(begin, end)});
+        } else {
+            config.obstacles.push_back(obstacle);
+        }
+    } else if (type == "Environment") {
+        double width = 0.0;
+        double height = 0.0;
+        bool valid = toDouble(nextField(cursor, end), width)
+                     && toDouble(nextField(cursor, end), height)
+                     && atLineEnd(cursor, end)
+                     && width > 0 && height > 0;
+        if (!valid) {
+            config.errors.push_back({line, "Failed to read Environment data: " + std::string(begin, end)});
+        } else {
+            config.width = width;
+            config.height = height;
+        }
+    } else {
+        config.errors.push_back({line, "Incorrect configuration string format: " + std::string(begin, end)});
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Parses configuration text held in memory.
+ * @param begin First character of the text.
+ * @param end One past the last character.
+ * @param config Receives the robots, obstacles and errors, appended to what it already holds.
+ * @param firstLine Line number of the first line of the text.
+ * @return Number of lines in the text.
+ */
+int ConfigParser::parse(const char* begin, const char* end, SceneConfig& config, int firstLine) {
+    int line = firstLine;
+    while (begin < end) {
+        auto newline = static_cast<const char*>(std::memchr(begin, '\n', static_cast<size_t>(end - begin)));
+        const char* lineEnd = newline ? newline : end;
+        parseLine(begin, lineEnd, line, config);
+        ++line;
+        begin = newline ? newline + 1 : end;
+    }
+    return line - firstLine;
+}
+
+/**
+ * @brief Parses a configuration file.
+ * @param path Path of the file.
+ * @param config Receives the robots, obstacles and errors of the file.
+ * @param error Receives the reason if the file cannot be read at all.
+ * @param threads Threads to parse on; 0 picks one per hardware thread for large files.
+ * @return False if the file cannot be read; malformed lines do not make it fail.
+ *
+ * Chunks are cut just after a newline, so no line is split. Each chunk numbers its lines from 1; the numbers are
+ * shifted by the line counts of the chunks before it while the chunks are joined.
+ */
+bool ConfigParser::parseFile(const std::string& path, SceneConfig& config, std::string& error, int threads) {
+    MappedFile file;
+    if (!file.open(path, error)) {
+        return false;
+    }
+    const char* begin = file.data();
+    const char* end = begin + file.size();
+
+    size_t chunks = threads > 0 ? static_cast<size_t>(threads) : std::max(1u, std::thread::hardware_concurrency());
+    chunks = std::min(chunks, std::max<size_t>(1, file.size() / minimumChunk));
+    if (chunks <= 1) {
+        parse(begin, end, config);
+        return true;
+    }
+
+    std::vector<const char*> cuts {begin};
+    for (size_t i = 1; i < chunks; ++i) {
+        const char* cut = std::max(begin + file.size() * i / chunks, cuts.back());
+        auto newline = static_cast<const char*>(std::memchr(cut, '\n', static_cast<size_t>(end - cut)));
+        cut = newline ? newline + 1 : end;
+        if (cut > cuts.back() && cut < end) {
+            cuts.push_back(cut);
+        }
+    }
+    cuts.push_back(end);
+
+    size_t parts = cuts.size() - 1;
+    std::vector<SceneConfig> results(parts);
+    std::vector<int> lineCounts(parts);
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < parts; ++i) {
+        workers.emplace_back([&, i] { lineCounts[i] = parse(cuts[i], cuts[i + 1], results[i]); });
+    }
+    lineCounts[0] = parse(cuts[0], cuts[1], results[0]);
+    for (auto& worker : workers) {
+        worker.join();
+    }
+
+    size_t robots = config.robots.size();
+    size_t obstacles = config.obstacles.size();
+    for (const auto& result : results) {
+        robots += result.robots.size();
+        obstacles += result.obstacles.size();
+    }
+    config.robots.reserve(robots);
+    config.obstacles.reserve(obstacles);
+    int offset = 0;
+    for (size_t i = 0; i < parts; ++i) {
+        if (results[i].width > 0) {
+            config.width = results[i].width;
+            config.height = results[i].height;
+        }
+        for (RobotConfig& robot : results[i].robots) {
+            robot.line += offset;
+            config.robots.push_back(robot);
+        }
+        for (ObstacleConfig& obstacle : results[i].obstacles) {
+            obstacle.line += offset;
+            config.obstacles.push_back(obstacle);
+        }
+        for (ConfigError& lineError : results[i].errors) {
+            lineError.line += offset;
+            config.errors.push_back(std::move(lineError));
+        }
+        offset += lineCounts[i];
+    }
+    return true;
+}
@@ -0,0 +1,103 @@
+/**
+ * @file ConfigParser.h
+ * @brief Parser of the text configuration format, shared by the core and GUI loaders.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef CONFIGPARSER_H
+#define CONFIGPARSER_H
+
+#include "vector"
+#include "string"
+#include "cstddef"
+#include "RobotStore.h"
+
+/**
+ * @brief One Robot line of a configuration.
+ */
+struct RobotConfig {
+    int line; ///< Line number in the file, starting at 1.
+    int id; ///< Robot identifier.
+    RobotKind kind; ///< Type of the robot.
+    double x; ///< x-coordinate of the centre.
+    double y; ///< y-coordinate of the centre.
+    double speed; ///< Speed in units per tick.
+    double orientation; ///< Orientation in degrees.
+    double sensorRange; ///< Sensor range in units.
+};
+
+/**
+ * @brief One Obstacle line of a configuration.
+ */
+struct ObstacleConfig {
+    int line; ///< Line number in the file, starting at 1.
+    int id; ///< Obstacle identifier.
+    double x; ///< x-coordinate of the centre.
+    double y; ///< y-coordinate of the centre.
+    double size; ///< Edge length.
+};
+
+/**
+ * @brief A malformed line of a configuration, or a line that could not be applied.
+ */
+struct ConfigError {
+    int line; ///< Line number in the file, starting at 1.
+    std::string message; ///< What is wrong, followed by the offending line.
+};
+
+/**
+ * @brief Everything read from a configuration, in file order.
+ */
+struct SceneConfig {
+    double width = 0.0; ///< Width from the last Environment line, or 0 if the file has none.
+    double height = 0.0; ///< Height from the last Environment line, or 0 if the file has none.
+    std::vector<RobotConfig> robots; ///< Well-formed Robot lines.
+    std::vector<ObstacleConfig> obstacles; ///< Well-formed Obstacle lines.
+    std::vector<ConfigError> errors; ///< Malformed lines, which are not in the lists above.
+};
+
+/**
+ * @class ConfigParser
+ * @brief Reads the text configuration format without per-line allocations.
+ *
+ * The format has one entity per line:
+ *
+ *     Robot autonomous|remote ID X Y SPEED ORIENTATION SENSOR_RANGE
+ *     Obstacle ID X Y SIZE
+ *     Environment WIDTH HEIGHT
+ *
+ * The optional Environment line sets the size of the world, which otherwise keeps its current size. Empty lines and lines starting with # are skipped; every other line that does not match is reported as an error
+ * with its line number. Fields are separated by spaces or tabs and converted with std::from_chars straight from the
+ * memory-mapped file. Large files are cut into chunks at line boundaries, parsed on several threads and joined in
+ * file order, so the result does not depend on the number of threads.
+ */
+class ConfigParser {
+public:
+    /**
+     * @brief Parses a configuration file.
+     * @param path Path of the file.
+     * @param config Receives the robots, obstacles and errors of the file.
+     * @param error Receives the reason if the file cannot be read at all.
+     * @param threads Threads to parse on; 0 picks one per hardware thread for large files.
+     * @return False if the file cannot be read; malformed lines do not make it fail.
+     */
+    static bool parseFile(const std::string& path, SceneConfig& config, std::string& error, int threads = 0);
+
+    /**
+     * @brief Parses configuration text held in memory.
+     * @param begin First character of the text.
+     * @param end One past the last character.
+     * @param config Receives the robots, obstacles and errors, appended to what it already holds.
+     * @param firstLine Line number of the first line of the text.
+     * @return Number of lines in the text.
+     */
+    static int parse(const char* begin, const char* end, SceneConfig& config, int firstLine = 1);
+
+private:
+    static constexpr size_t minimumChunk = 1 << 20; ///< Smallest chunk worth a thread of its own, in bytes.
+};
+
+#endif // CONFIGPARSER_H
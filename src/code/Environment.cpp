@@ -9,6 +9,11 @@
 #include "Environment.h"
 #include "RemoteControlledRobot.h"
 #include "AutonomousRobot.h"
+#include "Collision.h"
+#include "SceneSnapshot.h"
+#include "Profiler.h"
+#include "Logger.h"
+#include "algorithm"
 
 /**
  * @brief Constructor for the AutonomousRobot class.
@@ -29,75 +34,266 @@ Environment::~Environment() {
 /**
  * @brief Add a robot to the environment.
  * @param robot Unique pointer to the robot to be added.
+ * @return True if the robot was added, false if a robot with the same ID already exists; the new robot is then discarded.
  */
-void Environment::addRobot(std::unique_ptr<Robot> robot) {
-    robots.push_back(std::move(robot));
+bool Environment::addRobot(std::unique_ptr<Robot> robot) {
+    int id = robot->getID();
+    if (robotHandles.count(id)) {
+        return false;
+    }
+    robotStore.add(robot.get());
+    robotHandles.emplace(id, robots.insert(std::move(robot)));
+    spatialIndexDirty = true;
+    remoteRobotsDirty = true;
+    return true;
+}
+
+/**
+ * @brief Find a robot by its identifier.
+ * @param id Unique identifier of the robot.
+ * @return Pointer to the robot, or nullptr if there is no robot with that ID.
+ */
+Robot* Environment::findRobot(int id) {
+    return getRobot(getRobotHandle(id));
+}
+
+/**
+ * @brief Find an obstacle by its identifier.
+ * @param id Unique identifier of the obstacle.
+ * @return Pointer to the obstacle, or nullptr if there is no obstacle with that ID.
+ */
+Obstacle* Environment::findObstacle(int id) {
+    return getObstacle(getObstacleHandle(id));
+}
+
+/**
+ * @brief Get a robot by handle.
+ * @param handle Handle of the robot.
+ * @return Pointer to the robot, or nullptr if the handle is null or the robot has been removed.
+ */
+Robot* Environment::getRobot(SlotHandle handle) {
+    auto robot = robots.get(handle);
+    return robot ? robot->get() : nullptr;
+}
+
+/**
+ * @brief Get an obstacle by handle.
+ * @param handle Handle of the obstacle.
+ * @return Pointer to the obstacle, or nullptr if the handle is null or the obstacle has been removed.
+ */
+Obstacle* Environment::getObstacle(SlotHandle handle) {
+    auto obstacle = obstacles.get(handle);
+    return obstacle ? obstacle->get() : nullptr;
+}
+
+/**
+ * @brief Get the handle of a robot.
+ * @param id Unique identifier of the robot.
+ * @return The handle, or a null handle if there is no robot with that ID.
+ */
+SlotHandle Environment::getRobotHandle(int id) const {
+    auto it = robotHandles.find(id);
+    return it != robotHandles.end() ? it->second : SlotHandle();
+}
+
+/**
+ * @brief Get the handle of an obstacle.
+ * @param id Unique identifier of the obstacle.
+ * @return The handle, or a null handle if there is no obstacle with that ID.
+ */
+SlotHandle Environment::getObstacleHandle(int id) const {
+    auto it = obstacleHandles.find(id);
+    return it != obstacleHandles.end() ? it->second : SlotHandle();
 }
 
 /**
  * @brief Get a vector of all robots in the environment.
- * @return A vector of unique pointers to the robots in the environment.
+ * @return A vector of unique pointers to the robots in the environment, in robot store slot order.
  */
 std::vector<std::unique_ptr<Robot>>& Environment::getRobots() {
-    return robots;
+    return robots.values();
 }
 
 /**
  * @brief Clear the environment of all robots and obstacles.
  */
 void Environment::clear() {
+    robotStore.clear();
     robots.clear();
     obstacles.clear();
+    robotHandles.clear();
+    obstacleHandles.clear();
+    spatialIndexDirty = true;
+    remoteRobotsDirty = true;
+    obstacleTreeDirty = true;
 }
 
 /**
  * @brief Load the configuration of the environment from a file.
- * @param filename Name of the file containing the configuration.
+ * @param filename Name of the file containing the configuration, in the text format or as a binary scene snapshot.
  */
 void Environment::loadConfiguration(const std::string& filename) {
-    std::ifstream file(filename);
-    std::string line;
-    if (!file.is_open()) {
-        std::cerr << "Unable to open file: " << filename << std::endl;
+    PROFILE_SCOPE(ProfilePhase::ConfigLoad);
+    if (SceneSnapshot::isSnapshot(filename)) {
+        std::string error;
+        if (!loadSnapshot(filename, error)) {
+            LOG_ERROR(error);
+        }
         return;
     }
-    /// Read the file line by line
-    while (getline(file, line)) {
-        std::istringstream iss(line);
-        std::string type;
-        iss >> type; 
+    SceneConfig config;
+    std::string error;
+    if (!ConfigParser::parseFile(filename, config, error)) {
+        LOG_ERROR(error);
+        return;
+    }
+    /// Malformed lines and duplicate identifiers are reported and skipped; the rest of the file is still loaded.
+    addConfiguration(config, config.errors);
+    std::stable_sort(config.errors.begin(), config.errors.end(), [](const ConfigError& a, const ConfigError& b) { return a.line < b.line; });
+    for (const ConfigError& lineError : config.errors) {
+        LOG_ERROR(filename << ":" << lineError.line << ": " << lineError.message);
+    }
+}
+
+/**
+ * @brief Add the robots and obstacles of a parsed configuration to the environment.
+ * @param config The parsed configuration.
+ * @param errors Receives an error for every entity whose identifier is already taken; that entity is skipped.
+ *
+ * An Environment line in the configuration resizes the world before any robot is created, so the robots are bounded
+ * by the new size.
+ */
+void Environment::addConfiguration(const SceneConfig& config, std::vector<ConfigError>& errors) {
+    if (config.width > 0 && config.height > 0) {
+        width = config.width;
+        height = config.height;
+        spatialIndexDirty = true;
+    }
+    robotStore.reserve(robotStore.size() + config.robots.size());
+    robots.reserve(robots.size() + config.robots.size());
+    robotHandles.reserve(robotHandles.size() + config.robots.size());
+    for (const RobotConfig& robot : config.robots) {
+        bool added;
+        if (robot.kind == RobotKind::Autonomous) {
+            added = addRobot(std::make_unique<AutonomousRobot>(robot.id, std::make_pair(robot.x, robot.y), robot.speed, robot.orientation, robot.sensorRange, width, height, this));
+        } else {
+            added = addRobot(std::make_unique<RemoteControlledRobot>(robot.id, std::make_pair(robot.x, robot.y), robot.speed, robot.orientation, robot.sensorRange, this));
+        }
+        if (!added) {
+            errors.push_back({robot.line, "Duplicate robot ID, skipped: " + std::to_string(robot.id)});
+        }
+    }
+    obstacles.reserve(obstacles.size() + config.obstacles.size());
+    obstacleHandles.reserve(obstacleHandles.size() + config.obstacles.size());
+    for (const ObstacleConfig& obstacle : config.obstacles) {
+        if (!addObstacle(std::make_unique<Obstacle>(obstacle.id, std::make_pair(obstacle.x, obstacle.y), obstacle.size))) {
+            errors.push_back({obstacle.line, "Duplicate obstacle ID, skipped: " + std::to_string(obstacle.id)});
+        }
+    }
+}
 
-        if (type == "Robot") {
-            std::string robotType;
-            int id;
-            double x, y, speed, direction, sensor_range;
+/**
+ * @brief Add the robots and obstacles of a binary scene snapshot to the environment.
+ * @param filename Name of the snapshot file.
+ * @param error Receives the reason if the snapshot cannot be loaded.
+ * @return True on success. On failure the environment is left unchanged.
+ *
+ * The file is memory-mapped and nothing is parsed. The whole snapshot is validated first, since identifiers are
+ * reserved in the handle maps as they are checked. Then the robot columns are copied into the robot store in one
+ * block each, and every robot object is bound to its slot. The environment takes the width and height of the
+ * snapshot.
+ */
+bool Environment::loadSnapshot(const std::string& filename, std::string& error) {
+    SceneSnapshot snapshot;
+    if (!snapshot.open(filename, error)) {
+        return false;
+    }
+    const SceneSnapshotHeader& header = snapshot.header();
+    if (!(header.width > 0) || !(header.height > 0)) {
+        error = "Invalid environment size in snapshot: " + filename;
+        return false;
+    }
 
-            iss >> robotType >> id >> x >> y >> speed >> direction >> sensor_range; /// Read the robot data
+    size_t robotCount = snapshot.robotCount();
+    size_t obstacleCount = snapshot.obstacleCount();
+    const int32_t* robotIds = snapshot.robotIds();
+    const RobotKind* robotKinds = snapshot.robotKinds();
+    const int32_t* obstacleIds = snapshot.obstacleIds();
 
-            /// Check the type of the robot and create the appropriate object
-            if (robotType == "autonomous") {
-                addRobot(std::make_unique<AutonomousRobot>(id, std::make_pair(x, y), speed, direction, sensor_range, width, height, this));
-            } else if (robotType == "remote") {
-                addRobot(std::make_unique<RemoteControlledRobot>(id, std::make_pair(x, y), speed, direction, sensor_range,  this));
+    robotHandles.reserve(robotHandles.size() + robotCount);
+    for (size_t i = 0; i < robotCount; ++i) {
+        bool validKind = robotKinds[i] == RobotKind::Autonomous || robotKinds[i] == RobotKind::Remote;
+        if (!validKind || !robotHandles.emplace(robotIds[i], SlotHandle()).second) {
+            error = (validKind ? "Duplicate robot ID " : "Invalid kind of robot ") + std::to_string(robotIds[i]) + " in snapshot: " + filename;
+            for (size_t j = 0; j < i; ++j) {
+                robotHandles.erase(robotIds[j]);
             }
-        } else if (type == "Obstacle") { /// Read the obstacle data
-            int id;
-            double x, y, size;
-                if (iss >> id >> x >> y >> size) {
-                    addObstacle(std::make_unique<Obstacle>(id, std::make_pair(x, y), size)); /// Create the obstacle object
-                } else {
-                    std::cerr << "Failed to read Obstacle data: " << line << std::endl;
-                }
+            return false;
+        }
+    }
+    obstacleHandles.reserve(obstacleHandles.size() + obstacleCount);
+    for (size_t i = 0; i < obstacleCount; ++i) {
+        if (!obstacleHandles.emplace(obstacleIds[i], SlotHandle()).second) {
+            error = "Duplicate obstacle ID " + std::to_string(obstacleIds[i]) + " in snapshot: " + filename;
+            for (size_t j = 0; j < i; ++j) {
+                obstacleHandles.erase(obstacleIds[j]);
+            }
+            for (size_t j = 0; j < robotCount; ++j) {
+                robotHandles.erase(robotIds[j]);
+            }
+            return false;
+        }
+    }
+
+    width = header.width;
+    height = header.height;
+    const double* x = snapshot.robotX();
+    const double* y = snapshot.robotY();
+    const double* headings = snapshot.robotHeadings();
+    const double* speeds = snapshot.robotSpeeds();
+    const double* sensorRanges = snapshot.robotSensorRanges();
+    robotStore.reserve(robotStore.size() + robotCount);
+    robots.reserve(robots.size() + robotCount);
+    size_t first = robotStore.append(robotCount, robotIds, robotKinds, x, y, headings, speeds, sensorRanges);
+    for (size_t i = 0; i < robotCount; ++i) {
+        std::unique_ptr<Robot> robot;
+        if (robotKinds[i] == RobotKind::Autonomous) {
+            robot = std::make_unique<AutonomousRobot>(robotIds[i], std::make_pair(x[i], y[i]), speeds[i], headings[i], sensorRanges[i], width, height, this);
+        } else {
+            robot = std::make_unique<RemoteControlledRobot>(robotIds[i], std::make_pair(x[i], y[i]), speeds[i], headings[i], sensorRanges[i], this);
         }
+        robotStore.bind(first + i, robot.get());
+        robotHandles[robotIds[i]] = robots.insert(std::move(robot));
+    }
+
+    const double* obstacleX = snapshot.obstacleX();
+    const double* obstacleY = snapshot.obstacleY();
+    const double* obstacleSizes = snapshot.obstacleSizes();
+    obstacles.reserve(obstacles.size() + obstacleCount);
+    for (size_t i = 0; i < obstacleCount; ++i) {
+        auto obstacle = std::make_unique<Obstacle>(obstacleIds[i], std::make_pair(obstacleX[i], obstacleY[i]), obstacleSizes[i]);
+        obstacleHandles[obstacleIds[i]] = obstacles.insert(std::move(obstacle));
     }
-    file.close();
+
+    spatialIndexDirty = true;
+    remoteRobotsDirty = true;
+    obstacleTreeDirty = true;
+    return true;
 }
+
 /**
  * @brief Add an obstacle to the environment.
  * @param obstacle Unique pointer to the obstacle to be added.
+ * @return True if the obstacle was added, false if an obstacle with the same ID already exists; the new obstacle is then discarded.
  */
-void Environment::addObstacle(std::unique_ptr<Obstacle> obstacle) {
-    obstacles.push_back(std::move(obstacle));
+bool Environment::addObstacle(std::unique_ptr<Obstacle> obstacle) {
+    int id = obstacle->getId();
+    if (obstacleHandles.count(id)) {
+        return false;
+    }
+    obstacleHandles.emplace(id, obstacles.insert(std::move(obstacle)));
+    obstacleTreeDirty = true;
+    return true;
 }
 
 /**
@@ -106,13 +302,25 @@ void Environment::addObstacle(std::unique_ptr<Obstacle> obstacle) {
  * @return True if the obstacle was removed, false otherwise.
  */
 bool Environment::removeObstacle(int id) {
-    auto it = std::find_if(obstacles.begin(), obstacles.end(),
-                           [id](const std::unique_ptr<Obstacle>& obstacle) { return obstacle->getId() == id; });
-    if (it != obstacles.end()) {
-        obstacles.erase(it);
-        return true;
+    return removeObstacle(getObstacleHandle(id));
+}
+
+/**
+ * @brief Remove an obstacle from the environment.
+ * @param handle Handle of the obstacle to be removed.
+ * @return True if the obstacle was removed, false if the handle is null or stale.
+ *
+ * The last obstacle takes the place of the removed one, so removal does not shift the rest of the list.
+ */
+bool Environment::removeObstacle(SlotHandle handle) {
+    Obstacle* obstacle = getObstacle(handle);
+    if (!obstacle) {
+        return false;
     }
-    return false;
+    obstacleHandles.erase(obstacle->getId());
+    obstacles.remove(handle);
+    obstacleTreeDirty = true;
+    return true;
 }
 
 /**
@@ -121,13 +329,28 @@ bool Environment::removeObstacle(int id) {
  * @return True if the robot was removed, false otherwise.
  */
 bool Environment::removeRobot(int id) {
-    auto it = std::find_if(robots.begin(), robots.end(),
-                           [id](const std::unique_ptr<Robot>& robot) { return robot->getID() == id; });
-    if (it != robots.end()) {
-        robots.erase(it);
-        return true;
+    return removeRobot(getRobotHandle(id));
+}
+
+/**
+ * @brief Remove a robot from the environment.
+ * @param handle Handle of the robot to be removed.
+ * @return True if the robot was removed, false if the handle is null or stale.
+ *
+ * The last robot takes the place of the removed one, both in the slot map and in the robot store, so removal does
+ * not shift the rest of the list. This changes the order in which robots are updated.
+ */
+bool Environment::removeRobot(SlotHandle handle) {
+    Robot* robot = getRobot(handle);
+    if (!robot) {
+        return false;
     }
-    return false;
+    robotHandles.erase(robot->getID());
+    robotStore.remove(robots.denseIndex(handle));
+    robots.remove(handle);
+    spatialIndexDirty = true;
+    remoteRobotsDirty = true;
+    return true;
 }
 
 /**
@@ -135,20 +358,120 @@ bool Environment::removeRobot(int id) {
  * @return A vector of unique pointers to the obstacles in the environment.
  */
 const std::vector<std::unique_ptr<Obstacle>>& Environment::getObstacles() const {
-    return obstacles;
+    return obstacles.values();
+}
+
+/**
+ * @brief Rebuild the spatial index from the current robot positions.
+ *
+ * The cell size is the longest sensor reach (sensor range plus robot radius), so a sensor sweep touches at most the
+ * surrounding 3x3 cells. Robot queries are padded by the fastest robot's speed, which keeps them exact while robots
+ * move during the tick that follows the rebuild.
+ */
+void Environment::updateSpatialIndex() {
+    const double robotRadius = 10.0;
+    double maxSensorRange = 0.0;
+    double maxSpeed = 0.0;
+    for (size_t slot = 0; slot < robotStore.size(); ++slot) {
+        maxSensorRange = std::max(maxSensorRange, robotStore.sensorRanges[slot]);
+        maxSpeed = std::max(maxSpeed, std::fabs(robotStore.speeds[slot]));
+    }
+    spatialIndex.rebuild(robotStore, width, height, maxSensorRange + robotRadius, maxSpeed);
+    spatialIndexDirty = false;
+}
+
+/**
+ * @brief Get the spatial index over robots.
+ * @return Reference to the index, rebuilt first if robots were added or removed since the last rebuild.
+ */
+const SpatialHash& Environment::getSpatialIndex() {
+    if (spatialIndexDirty) {
+        updateSpatialIndex();
+    }
+    return spatialIndex;
+}
+
+/**
+ * @brief Rebuild the obstacle hierarchy from the current obstacles.
+ *
+ * Obstacles are static while the simulation runs, so this only has to be called when the simulation starts and after
+ * an obstacle has been added, removed or edited.
+ */
+void Environment::rebuildObstacleTree() {
+    obstacleTree.build(obstacles.values());
+    obstacleTreeDirty = false;
+}
+
+/**
+ * @brief Get the bounding-volume hierarchy over the obstacles.
+ * @return Reference to the hierarchy, rebuilt first if obstacles were added or removed since the last rebuild.
+ */
+const ObstacleTree& Environment::getObstacleTree() {
+    if (obstacleTreeDirty) {
+        rebuildObstacleTree();
+    }
+    return obstacleTree;
 }
 
 /**
  * @brief Find all remote-controlled robots in the environment.
- * @return A vector of pointers to the remote-controlled robots.
- */
-std::vector<RemoteControlledRobot*> Environment::findRemoteControlledRobots() {
-    std::vector<RemoteControlledRobot*> remoteRobots;
-    for (const auto& robot : robots) {
-        RemoteControlledRobot* rcr = dynamic_cast<RemoteControlledRobot*>(robot.get());
-        if (rcr) {
-            remoteRobots.push_back(rcr);
+ * @return Pointers to the remote-controlled robots, valid until the next robot is added or removed.
+ *
+ * The list is refilled from the store's slot list of remote robots only after the robot set has changed, so repeated
+ * key presses neither test every robot's type nor allocate.
+ */
+const std::vector<RemoteControlledRobot*>& Environment::findRemoteControlledRobots() {
+    if (remoteRobotsDirty) {
+        remoteRobots.clear();
+        for (uint32_t slot : robotStore.remoteSlots) {
+            remoteRobots.push_back(static_cast<RemoteControlledRobot*>(robotStore.handles[slot]));
         }
+        remoteRobotsDirty = false;
     }
     return remoteRobots;
 }
+
+/**
+ * @brief Compute how far a robot gets along a straight move before it touches an obstacle or another robot.
+ * @param id Identifier of the moving robot, which is skipped among the robots.
+ * @param x x-coordinate of the robot centre.
+ * @param y y-coordinate of the robot centre.
+ * @param dx Displacement along x of the intended move.
+ * @param dy Displacement along y of the intended move.
+ * @param radius Radius of the moving robot.
+ * @return Fraction of the move in [0, 1] the robot can make, stopping contactSkin short of the first contact.
+ *
+ * The robot centre is swept as a point against obstacle bounds grown by the radius and against discs of twice the
+ * radius around the other robots, so one time-of-impact test per candidate replaces probing the path step by step.
+ * Shapes the robot already overlaps do not stop it, so overlapping robots can separate.
+ */
+double Environment::sweepRobot(int id, double x, double y, double dx, double dy, double radius) {
+    double length = std::sqrt(dx * dx + dy * dy);
+    if (length == 0.0) {
+        return 1.0;
+    }
+
+    double impact = Collision::NoImpact;
+    getObstacleTree().forEachAlongSegment(x, y, x + dx, y + dy, radius, [&](const ObstacleTree::Item& obstacle) {
+        impact = std::min(impact, Collision::boxTimeOfImpact(x, y, dx, dy, obstacle.left - radius, obstacle.top - radius,
+                                                             obstacle.right + radius, obstacle.bottom + radius));
+        return false;
+    });
+
+    double contact = 2 * radius;
+    QRectF sweep(std::min(x, x + dx) - contact, std::min(y, y + dy) - contact,
+                 std::fabs(dx) + 2 * contact, std::fabs(dy) + 2 * contact);
+    const double* otherX = robotStore.observedX();
+    const double* otherY = robotStore.observedY();
+    getSpatialIndex().forEachRobot(sweep, [&](uint32_t other) {
+        if (robotStore.ids[other] != id) {
+            impact = std::min(impact, Collision::discTimeOfImpact(x, y, dx, dy, otherX[other], otherY[other], contact));
+        }
+        return false;
+    });
+
+    if (impact > 1.0) {
+        return 1.0;
+    }
+    return std::max(0.0, impact - contactSkin / length);
+}
@@ -13,6 +13,9 @@
 
 #include "Robot.h"
 #include "Obstacle.h"
+#include "RobotStore.h"
+#include "SpatialHash.h"
+#include "ObstacleTree.h"
 #include "vector"
 #include "cmath"
 #include "memory"
@@ -21,6 +24,10 @@
 #include "fstream"
 #include "sstream"
 #include "iostream"
+#include "mutex"
+#include "unordered_map"
+#include "SlotMap.h"
+#include "ConfigParser.h"
 
 class RemoteControlledRobot;
 /**
@@ -38,18 +45,50 @@ public:
     void clear();
     bool removeRobot(int id);
     bool removeObstacle(int id);
+    bool removeRobot(SlotHandle handle);
+    bool removeObstacle(SlotHandle handle);
 
-    void addRobot(std::unique_ptr<Robot> robot);
+    bool addRobot(std::unique_ptr<Robot> robot);
+    Robot* findRobot(int id); /// Find a robot by identifier in constant time; nullptr if there is none.
+    Obstacle* findObstacle(int id); /// Find an obstacle by identifier in constant time; nullptr if there is none.
+    Robot* getRobot(SlotHandle handle); /// Get a robot by handle; nullptr if it has been removed.
+    Obstacle* getObstacle(SlotHandle handle); /// Get an obstacle by handle; nullptr if it has been removed.
+    SlotHandle getRobotHandle(int id) const; /// Handle of the robot with an identifier; null if there is none.
+    SlotHandle getObstacleHandle(int id) const; /// Handle of the obstacle with an identifier; null if there is none.
+    [[nodiscard]] SlotHandle robotHandleAt(size_t slot) const { return robots.handleAt(slot); } /// Handle of the robot in a store slot.
+    [[nodiscard]] SlotHandle obstacleHandleAt(size_t index) const { return obstacles.handleAt(index); } /// Handle of the obstacle at a position of getObstacles().
     std::vector<std::unique_ptr<Robot>>& getRobots();
+    RobotStore& getRobotStore() { return robotStore; } /// Get the component store holding the state of all robots.
     void loadConfiguration(const std::string& filename);
-    void addObstacle(std::unique_ptr<Obstacle> obstacle);
-    std::vector<RemoteControlledRobot*> findRemoteControlledRobots(); /// Find all remote controlled robots in the environment.
+    bool loadSnapshot(const std::string& filename, std::string& error); /// Add the robots and obstacles of a binary scene snapshot.
+    void addConfiguration(const SceneConfig& config, std::vector<ConfigError>& errors); /// Add the robots and obstacles of a parsed configuration.
+    bool addObstacle(std::unique_ptr<Obstacle> obstacle);
+    const std::vector<RemoteControlledRobot*>& findRemoteControlledRobots(); /// Get all remote controlled robots, cached until the robot set changes.
     [[nodiscard]] const std::vector<std::unique_ptr<Obstacle>>& getObstacles() const; /// Get a vector of all obstacles in the environment.
+    void updateSpatialIndex(); /// Rebuild the spatial index from the current robot positions.
+    const SpatialHash& getSpatialIndex(); /// Get the spatial index, rebuilding it first if robots were added or removed.
+    void rebuildObstacleTree(); /// Rebuild the obstacle hierarchy after obstacles were added, removed or edited.
+    const ObstacleTree& getObstacleTree(); /// Get the obstacle hierarchy, rebuilding it first if the obstacle set changed.
+    double sweepRobot(int id, double x, double y, double dx, double dy, double radius); /// Fraction of a move a robot can make before contact.
+
+    std::mutex& getMutex() { return mutex; } /// Lock held while ticking or editing, so threads other than the simulation's can edit safely.
+
+    static constexpr double contactSkin = 0.01; /// Gap left between a robot and whatever stopped it.
 
 
 private:
-    std::vector<std::unique_ptr<Robot>> robots; /// Vector of unique pointers to the robots in the environment.
-    std::vector<std::unique_ptr<Obstacle>> obstacles; /// Vector of unique pointers to the obstacles in the environment.
+    SlotMap<std::unique_ptr<Robot>> robots; /// The robots in the environment, dense and addressed by handle.
+    SlotMap<std::unique_ptr<Obstacle>> obstacles; /// The obstacles in the environment, dense and addressed by handle.
+    RobotStore robotStore; /// Robot state as contiguous columns, slot i belongs to the robot at dense position i.
+    std::unordered_map<int, SlotHandle> robotHandles; /// Handle of each robot, by identifier.
+    std::unordered_map<int, SlotHandle> obstacleHandles; /// Handle of each obstacle, by identifier.
+    SpatialHash spatialIndex; /// Grid over robots used by sensor and collision queries.
+    bool spatialIndexDirty = true; /// Set when the robot set changed since the last rebuild of the spatial index.
+    ObstacleTree obstacleTree; /// Bounding-volume hierarchy over the static obstacles.
+    bool obstacleTreeDirty = true; /// Set when the obstacle set changed since the last rebuild of the hierarchy.
+    std::vector<RemoteControlledRobot*> remoteRobots; /// Cached result of findRemoteControlledRobots.
+    bool remoteRobotsDirty = true; /// Set when the robot set changed since remoteRobots was filled.
+    std::mutex mutex; /// Serializes ticks and edits; see getMutex.
 };
 
 #endif // ENVIRONMENT_H
\ No newline at end of file
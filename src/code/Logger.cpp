@@ -0,0 +1,260 @@
+/**
+ * @file Logger.cpp
+ * @brief Implements the asynchronous logger declared in Logger.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "Logger.h"
+#include "algorithm"
+#include "charconv"
+#include "chrono"
+#include "cstdio"
+#include "cstring"
+
+/**
+ * @brief Lease of a ring by the current thread, returned when the thread ends.
+ */
+struct LoggerRingLease {
+    Logger::Ring* ring = nullptr; ///< The leased ring, or nullptr before the thread's first line.
+
+    ~LoggerRingLease() {
+        if (ring) {
+            ring->owned.store(false, std::memory_order_release);
+        }
+    }
+};
+
+namespace {
+
+thread_local LoggerRingLease lease; ///< Ring of the current thread.
+
+} // namespace
+
+/**
+ * @brief Gets the process-wide logger, starting its flush thread on first use.
+ * @return The logger.
+ */
+Logger& Logger::instance() {
+    static Logger logger;
+    return logger;
+}
+
+/**
+ * @brief Starts the flush thread.
+ */
+Logger::Logger() : flusher(&Logger::run, this) {}
+
+/**
+ * @brief Stops the flush thread after it has written every remaining line.
+ */
+Logger::~Logger() {
+    {
+        std::lock_guard<std::mutex> lock(drainMutex);
+        stopping = true;
+    }
+    wake.notify_one();
+    flusher.join();
+}
+
+/**
+ * @brief Parses the name of a level.
+ * @param name debug, info, warning, error or off.
+ * @param level Receives the level.
+ * @return False for an unknown name.
+ */
+bool Logger::parseLevel(const std::string& name, LogLevel& level) {
+    static const std::pair<const char*, LogLevel> names[] = {
+        {"debug", LogLevel::Debug}, {"info", LogLevel::Info}, {"warning", LogLevel::Warning},
+        {"error", LogLevel::Error}, {"off", LogLevel::Off}
+    };
+    for (const auto& [candidate, value] : names) {
+        if (name == candidate) {
+            level = value;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Hands a free ring, or a new one, to the calling thread.
+ * @return The ring, owned by the calling thread until it ends.
+ */
+Logger::Ring* Logger::acquireRing() {
+    std::lock_guard<std::mutex> lock(ringsMutex);
+    for (auto& ring : rings) {
+        bool expected = false;
+        if (ring->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return ring.get();
+        }
+    }
+    rings.push_back(std::make_unique<Ring>());
+    rings.back()->owned.store(true, std::memory_order_relaxed);
+    return rings.back().get();
+}
+
+/**
+ * @brief Appends a line to the calling thread's ring.
+ * @param level Level of the line.
+ * @param text The line, without a trailing newline.
+ * @param length Length of the line; at most maxLineLength.
+ *
+ * Wakes the flush thread once the ring is half full, and waits for it while the ring is full.
+ */
+void Logger::write(LogLevel level, const char* text, size_t length) {
+    if (!lease.ring) {
+        lease.ring = acquireRing();
+    }
+    Ring& ring = *lease.ring;
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    while (head - ring.tail.load(std::memory_order_acquire) >= ringCapacity) {
+        wake.notify_one();
+        std::this_thread::yield();
+    }
+    Record& record = ring.records[head & (ringCapacity - 1)];
+    record.time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    record.level = level;
+    record.length = static_cast<uint16_t>(std::min(length, maxLineLength));
+    std::memcpy(record.text, text, record.length);
+    ring.head.store(head + 1, std::memory_order_release);
+    if (head + 1 - ring.tail.load(std::memory_order_relaxed) >= ringCapacity / 2) {
+        wake.notify_one();
+    }
+}
+
+/**
+ * @brief Writes every line logged so far before returning.
+ */
+void Logger::flush() {
+    std::lock_guard<std::mutex> lock(drainMutex);
+    drain();
+}
+
+/**
+ * @brief Writes the lines of every ring to stderr in one block, merged by the time they were logged.
+ *
+ * The caller holds drainMutex. Records are read in place; a ring's tail only moves past them after they are
+ * written, so their owner cannot overwrite them meanwhile.
+ */
+void Logger::drain() {
+    std::vector<std::pair<Ring*, uint64_t>> reached;
+    {
+        std::lock_guard<std::mutex> lock(ringsMutex);
+        batch.clear();
+        for (auto& ring : rings) {
+            uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (uint64_t i = tail; i < head; ++i) {
+                batch.push_back(&ring->records[i & (ringCapacity - 1)]);
+            }
+            if (head != tail) {
+                reached.emplace_back(ring.get(), head);
+            }
+        }
+    }
+    if (batch.empty()) {
+        return;
+    }
+    std::stable_sort(batch.begin(), batch.end(), [](const Record* a, const Record* b) { return a->time < b->time; });
+    output.clear();
+    for (const Record* record : batch) {
+        output += '[';
+        output += levelName(record->level);
+        output += "] ";
+        output.append(record->text, record->length);
+        output += '\n';
+    }
+    std::fwrite(output.data(), 1, output.size(), stderr);
+    std::fflush(stderr);
+    for (const auto& [ring, head] : reached) {
+        ring->tail.store(head, std::memory_order_release);
+    }
+}
+
+/**
+ * @brief Body of the flush thread: drains the rings every flushIntervalMs, or sooner when woken.
+ */
+void Logger::run() {
+    std::unique_lock<std::mutex> lock(drainMutex);
+    while (!stopping) {
+        wake.wait_for(lock, std::chrono::milliseconds(flushIntervalMs));
+        drain();
+    }
+    drain();
+}
+
+/**
+ * @brief Gets the name of a level as written in front of a line.
+ * @param level The level.
+ * @return Name in lower case.
+ */
+const char* Logger::levelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "debug";
+        case LogLevel::Info: return "info";
+        case LogLevel::Warning: return "warning";
+        case LogLevel::Error: return "error";
+        default: return "off";
+    }
+}
+
+/**
+ * @brief Appends text, cutting it at Logger::maxLineLength.
+ * @param value The text.
+ * @param count Length of the text.
+ */
+void LogLine::append(const char* value, size_t count) {
+    count = std::min(count, Logger::maxLineLength - length);
+    std::memcpy(text + length, value, count);
+    length += count;
+}
+
+LogLine& LogLine::operator<<(const char* value) {
+    append(value, std::strlen(value));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(const std::string& value) {
+    append(value.data(), value.size());
+    return *this;
+}
+
+LogLine& LogLine::operator<<(char value) {
+    append(&value, 1);
+    return *this;
+}
+
+/**
+ * @brief Appends an integer in decimal.
+ * @param value The integer.
+ * @return The line.
+ */
+template<typename Integer>
+LogLine& LogLine::appendInteger(Integer value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    append(digits, static_cast<size_t>(result.ptr - digits));
+    return *this;
+}
+
+LogLine& LogLine::operator<<(int value) { return appendInteger(value); }
+LogLine& LogLine::operator<<(long value) { return appendInteger(value); }
+LogLine& LogLine::operator<<(long long value) { return appendInteger(value); }
+LogLine& LogLine::operator<<(unsigned value) { return appendInteger(value); }
+LogLine& LogLine::operator<<(unsigned long value) { return appendInteger(value); }
+LogLine& LogLine::operator<<(unsigned long long value) { return appendInteger(value); }
+
+/**
+ * @brief Appends a number with six significant digits, as std::ostream writes it by default.
+ * @param value The number.
+ * @return The line.
+ */
+LogLine& LogLine::operator<<(double value) {
+    char digits[32];
+    int count = std::snprintf(digits, sizeof(digits), "%g", value);
+    append(digits, static_cast<size_t>(std::max(0, std::min(count, static_cast<int>(sizeof(digits)) - 1))));
+    return *this;
+}
@@ -0,0 +1,193 @@
+/**
+ * @file Logger.h
+ * @brief Asynchronous leveled logger with per-thread lock-free buffers and a background flush thread.
+ *
+ * A log call formats its line into a fixed-size record and appends it to a ring owned by the calling thread, so the
+ * caller never takes a lock, never touches a stream and never waits for the terminal. A background thread drains
+ * every ring a few times per second and writes the lines to stderr in one block.
+ *
+ * Lines below the runtime level cost one relaxed atomic load and are not formatted. Lines below the compile-time
+ * level ROBOT_SIM_LOG_LEVEL (for example `qmake DEFINES+=ROBOT_SIM_LOG_LEVEL=2` to keep warnings and errors) are
+ * removed by the compiler.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "atomic"
+#include "condition_variable"
+#include "memory"
+#include "mutex"
+#include "string"
+#include "thread"
+#include "vector"
+#include "cstddef"
+#include "cstdint"
+
+#ifndef ROBOT_SIM_LOG_LEVEL
+#define ROBOT_SIM_LOG_LEVEL 0
+#endif
+
+/**
+ * @brief Severity of a log line, from the most to the least verbose.
+ */
+enum class LogLevel : uint8_t {
+    Debug, ///< Details of individual edits, such as every obstacle created.
+    Info, ///< Notable events.
+    Warning, ///< Requests that failed without harm, such as editing a removed robot.
+    Error, ///< Failures the user must know about, such as an unreadable configuration.
+    Off ///< Disables logging when used as the level.
+};
+
+/**
+ * @class Logger
+ * @brief Collects log lines from every thread and writes them to stderr from a background thread.
+ *
+ * Each logging thread owns a single-producer ring of records; rings are reused by later threads, as in Profiler.
+ * Lines of one thread keep their order; lines of different threads are merged by the time they were logged. A
+ * thread whose ring is full wakes the flush thread and waits for room instead of dropping lines, so a burst of
+ * debug output slows the logging thread down to the speed of the terminal but loses nothing.
+ */
+class Logger {
+public:
+    static constexpr LogLevel compiledLevel = static_cast<LogLevel>(ROBOT_SIM_LOG_LEVEL); ///< Lines below it are compiled out.
+    static constexpr size_t maxLineLength = 496; ///< Longer lines are cut.
+
+    /**
+     * @brief Gets the process-wide logger, starting its flush thread on first use.
+     * @return The logger.
+     */
+    static Logger& instance();
+
+    /**
+     * @brief Checks whether lines of a level are written. Cheap enough for every log call.
+     * @param level The level.
+     * @return True if the level is at or above both the compile-time and the runtime level.
+     */
+    static bool enabled(LogLevel level) {
+        return level >= compiledLevel && static_cast<uint8_t>(level) >= threshold.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * @brief Sets the runtime level. Lines below it are skipped without being formatted.
+     * @param level The lowest level written; Info by default.
+     */
+    static void setLevel(LogLevel level) { threshold.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+
+    /**
+     * @brief Parses the name of a level.
+     * @param name debug, info, warning, error or off.
+     * @param level Receives the level.
+     * @return False for an unknown name.
+     */
+    static bool parseLevel(const std::string& name, LogLevel& level);
+
+    /**
+     * @brief Appends a line to the calling thread's ring.
+     * @param level Level of the line.
+     * @param text The line, without a trailing newline.
+     * @param length Length of the line; at most maxLineLength.
+     */
+    void write(LogLevel level, const char* text, size_t length);
+
+    /**
+     * @brief Writes every line logged so far before returning.
+     */
+    void flush();
+
+    ~Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+private:
+    static constexpr size_t ringCapacity = 256; ///< Records per ring; a power of two.
+    static constexpr int flushIntervalMs = 50; ///< Longest time a line waits in a ring.
+
+    /**
+     * @brief One log line in a ring.
+     */
+    struct Record {
+        int64_t time; ///< When the line was logged, in nanoseconds of the steady clock.
+        LogLevel level; ///< Level of the line.
+        uint16_t length; ///< Length of the text.
+        char text[maxLineLength]; ///< The line, not terminated.
+    };
+
+    /**
+     * @brief Ring of records written by one thread at a time and drained by the flush thread.
+     */
+    struct Ring {
+        std::unique_ptr<Record[]> records{new Record[ringCapacity]}; ///< The lines.
+        std::atomic<uint64_t> head{0}; ///< Number of lines ever written; advanced by the owner.
+        std::atomic<uint64_t> tail{0}; ///< Number of lines ever drained; advanced by the drainer.
+        std::atomic<bool> owned{false}; ///< Set while a thread logs into the ring.
+    };
+
+    friend struct LoggerRingLease;
+
+    Logger();
+    Ring* acquireRing(); ///< Hand a free ring, or a new one, to the calling thread.
+    void drain(); ///< Write the lines of every ring to stderr; the caller holds drainMutex.
+    void run(); ///< Body of the flush thread.
+    static const char* levelName(LogLevel level); ///< Name of a level as written in front of a line.
+
+    inline static std::atomic<uint8_t> threshold{static_cast<uint8_t>(LogLevel::Info)}; ///< Runtime level.
+    std::mutex ringsMutex; ///< Guards the ring list.
+    std::vector<std::unique_ptr<Ring>> rings; ///< Every ring ever handed out.
+    std::mutex drainMutex; ///< Serializes draining between the flush thread and flush().
+    std::condition_variable wake; ///< Wakes the flush thread early when a ring fills up or on shutdown.
+    bool stopping = false; ///< Set when the flush thread must finish; guarded by drainMutex.
+    std::vector<const Record*> batch; ///< Records of one drain, reused.
+    std::string output; ///< Text of one drain, reused.
+    std::thread flusher; ///< The flush thread.
+};
+
+/**
+ * @class LogLine
+ * @brief Formats one log line in place and hands it to the logger when it goes out of scope.
+ */
+class LogLine {
+public:
+    explicit LogLine(LogLevel level) : level(level) {}
+    ~LogLine() { Logger::instance().write(level, text, length); }
+    LogLine(const LogLine&) = delete;
+    LogLine& operator=(const LogLine&) = delete;
+
+    LogLine& operator<<(const char* value);
+    LogLine& operator<<(const std::string& value);
+    LogLine& operator<<(char value);
+    LogLine& operator<<(int value);
+    LogLine& operator<<(long value);
+    LogLine& operator<<(long long value);
+    LogLine& operator<<(unsigned value);
+    LogLine& operator<<(unsigned long value);
+    LogLine& operator<<(unsigned long long value);
+    LogLine& operator<<(double value);
+
+private:
+    void append(const char* value, size_t count); ///< Append text, cutting it at maxLineLength.
+    template<typename Integer> LogLine& appendInteger(Integer value); ///< Append an integer in decimal.
+
+    LogLevel level; ///< Level of the line.
+    size_t length = 0; ///< Characters formatted so far.
+    char text[Logger::maxLineLength]; ///< The line.
+};
+
+/// Logs a line built with <<, formatting it only if the level is enabled.
+#define ROBOT_SIM_LOG(level, message) \
+    do { \
+        if (Logger::enabled(level)) { \
+            LogLine logLine(level); \
+            logLine << message; \
+        } \
+    } while (0)
+
+#define LOG_DEBUG(message) ROBOT_SIM_LOG(LogLevel::Debug, message)
+#define LOG_INFO(message) ROBOT_SIM_LOG(LogLevel::Info, message)
+#define LOG_WARNING(message) ROBOT_SIM_LOG(LogLevel::Warning, message)
+#define LOG_ERROR(message) ROBOT_SIM_LOG(LogLevel::Error, message)
+
+#endif // LOGGER_H
@@ -0,0 +1,64 @@
+/**
+ * @file MappedFile.cpp
+ * @brief Implements the read-only file mapping declared in MappedFile.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "MappedFile.h"
+#include "fcntl.h"
+#include "unistd.h"
+#include "sys/mman.h"
+#include "sys/stat.h"
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+/**
+ * @brief Maps a file, replacing any file mapped before.
+ * @param path Path of the file.
+ * @param error Receives the reason if the file cannot be mapped.
+ * @return True on success; an empty file maps to an empty range.
+ */
+bool MappedFile::open(const std::string& path, std::string& error) {
+    close();
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        error = "Unable to open file: " + path;
+        return false;
+    }
+    struct stat status {};
+    if (fstat(fd, &status) != 0) {
+        ::close(fd);
+        error = "Unable to read file: " + path;
+        return false;
+    }
+    if (status.st_size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void* result = mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);  /// The mapping keeps the file referenced.
+    if (result == MAP_FAILED) {
+        error = "Unable to map file: " + path;
+        return false;
+    }
+    mapping = result;
+    length = static_cast<size_t>(status.st_size);
+    madvise(mapping, length, MADV_SEQUENTIAL);
+    return true;
+}
+
+/**
+ * @brief Unmaps the current file, if any.
+ */
+void MappedFile::close() {
+    if (mapping) {
+        munmap(mapping, length);
+    }
+    mapping = nullptr;
+    length = 0;
+}
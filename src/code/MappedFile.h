@@ -0,0 +1,47 @@
+/**
+ * @file MappedFile.h
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include "cstddef"
+#include "string"
+
+/**
+ * @class MappedFile
+ * @brief Maps a file into memory for reading and unmaps it on destruction.
+ *
+ * Loaders read straight out of the page cache through the mapping instead of copying the file into a buffer first.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /**
+     * @brief Maps a file, replacing any file mapped before.
+     * @param path Path of the file.
+     * @param error Receives the reason if the file cannot be mapped.
+     * @return True on success; an empty file maps to an empty range.
+     */
+    bool open(const std::string& path, std::string& error);
+
+    [[nodiscard]] const char* data() const { return static_cast<const char*>(mapping); } /// First byte of the file, or nullptr if it is empty.
+    [[nodiscard]] size_t size() const { return length; } /// Length of the file in bytes.
+
+private:
+    void close(); ///< Unmap the current file, if any.
+
+    void* mapping = nullptr; ///< Start of the mapping, or nullptr while nothing is mapped.
+    size_t length = 0; ///< Length of the mapping in bytes.
+};
+
+#endif // MAPPEDFILE_H
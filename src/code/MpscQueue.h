@@ -0,0 +1,111 @@
+/**
+ * @file MpscQueue.h
+ * @brief Bounded lock-free queue for many producer threads and one consumer thread.
+ *
+ * Commands arrive from the GUI thread and from scripts on threads of their own, while the simulation thread
+ * consumes them once per tick. A producer only ever races other producers for a position, and never waits for the
+ * consumer or takes a lock the tick holds.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include "atomic"
+#include "memory"
+#include "cstddef"
+#include "cstdint"
+
+/**
+ * @class MpscQueue
+ * @brief Fixed-capacity ring of cells, each tagged with a sequence number.
+ *
+ * A producer claims the next position with a compare-and-swap, writes the value into the cell, then publishes it by
+ * advancing the cell's sequence number. The consumer takes a cell once its sequence shows it was published and hands
+ * it back by advancing the sequence by one lap. The ring is allocated once, so pushing and popping never allocate.
+ *
+ * @tparam T Value type; must be default-constructible and copy-assignable.
+ */
+template <typename T>
+class MpscQueue {
+public:
+    /**
+     * @brief Creates an empty queue.
+     * @param capacity Minimum number of values the queue holds; rounded up to a power of two.
+     */
+    explicit MpscQueue(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        mask = rounded - 1;
+        cells = std::make_unique<Cell[]>(rounded);
+        for (size_t i = 0; i < rounded; ++i) {
+            cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Appends a value. Safe from any number of threads at once.
+     * @param value Value to append.
+     * @return False if the queue is full; the value is then dropped.
+     */
+    bool push(const T& value) {
+        size_t position = enqueuePosition.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &cells[position & mask];
+            size_t sequence = cell->sequence.load(std::memory_order_acquire);
+            auto lag = static_cast<std::ptrdiff_t>(sequence - position);
+            if (lag == 0) {
+                if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (lag < 0) {
+                return false;
+            } else {
+                position = enqueuePosition.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = value;
+        cell->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * @brief Takes the oldest published value. Consumer thread only.
+     * @param value Receives the value.
+     * @return False if there is nothing to take.
+     */
+    bool pop(T& value) {
+        Cell& cell = cells[dequeuePosition & mask];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (static_cast<std::ptrdiff_t>(sequence - (dequeuePosition + 1)) < 0) {
+            return false;
+        }
+        value = cell.value;
+        cell.sequence.store(dequeuePosition + mask + 1, std::memory_order_release);
+        ++dequeuePosition;
+        return true;
+    }
+
+    [[nodiscard]] size_t capacity() const { return mask + 1; } /// Number of values the queue holds.
+
+private:
+    /**
+     * @brief One position of the ring.
+     */
+    struct Cell {
+        std::atomic<size_t> sequence{0}; ///< Equals the position while free, the position plus one once published.
+        T value{}; ///< The queued value.
+    };
+
+    std::unique_ptr<Cell[]> cells; ///< The ring.
+    size_t mask = 0; ///< Capacity minus one, to wrap positions.
+    alignas(64) std::atomic<size_t> enqueuePosition{0}; ///< Next position producers claim; shared by all producers.
+    alignas(64) size_t dequeuePosition = 0; ///< Next position the consumer takes.
+};
+
+#endif // MPSCQUEUE_H
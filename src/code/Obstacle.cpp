@@ -9,6 +9,7 @@
  */
 
 #include "Obstacle.h"
+#include "Logger.h"
 
 /**
  * @brief Constructs an Obstacle object and logs its creation.
@@ -16,11 +17,12 @@
  * @param position The initial position of the obstacle.
  * @param size The size of the obstacle.
  *
- * This constructor initializes the Obstacle with the given ID, position, and size, and logs the creation details.
+ * This constructor initializes the Obstacle with the given ID, position, and size, and logs the creation details
+ * at debug level.
  */
 Obstacle::Obstacle(int id, std::pair<double, double> position, double size)
         : id(id), size(size), position(position) {
-    std::cout << "Obstacle created with ID: " << id << ", at (" << position.first << ", " << position.second << ") with size " << size << std::endl;
+    LOG_DEBUG("Obstacle created with ID: " << id << ", at (" << position.first << ", " << position.second << ") with size " << size);
 }
 
 /**
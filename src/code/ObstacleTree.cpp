@@ -0,0 +1,72 @@
+/**
+ * @file ObstacleTree.cpp
+ * @brief Implements the obstacle hierarchy declared in ObstacleTree.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "ObstacleTree.h"
+#include "algorithm"
+
+/**
+ * @brief Rebuilds the hierarchy from a set of obstacles.
+ * @param obstacles Obstacles to index.
+ */
+void ObstacleTree::build(const std::vector<std::unique_ptr<Obstacle>>& obstacles) {
+    nodes.clear();
+    items.clear();
+    if (obstacles.empty()) {
+        return;
+    }
+
+    items.reserve(obstacles.size());
+    for (const auto& obstacle : obstacles) {
+        QRectF bounds = obstacle->getBounds();
+        items.push_back({bounds.left(), bounds.top(), bounds.right(), bounds.bottom(), obstacle.get()});
+    }
+    nodes.reserve(2 * (items.size() / leafSize + 1));
+    buildRange(0, static_cast<uint32_t>(items.size()), 0);
+}
+
+/**
+ * @brief Builds the subtree over a range of items.
+ * @param begin First item of the range.
+ * @param end One past the last item of the range.
+ * @param depth Depth of the node being built.
+ * @return Index of the node created for the range.
+ *
+ * The range is split at the median centre along the longest axis of its bounds, so the tree stays balanced no
+ * matter how the obstacles are distributed.
+ */
+uint32_t ObstacleTree::buildRange(uint32_t begin, uint32_t end, int depth) {
+    Node node{items[begin].left, items[begin].top, items[begin].right, items[begin].bottom, begin, 0};
+    for (uint32_t i = begin + 1; i < end; ++i) {
+        node.left = std::min(node.left, items[i].left);
+        node.top = std::min(node.top, items[i].top);
+        node.right = std::max(node.right, items[i].right);
+        node.bottom = std::max(node.bottom, items[i].bottom);
+    }
+
+    uint32_t index = static_cast<uint32_t>(nodes.size());
+    nodes.push_back(node);
+    if (end - begin <= leafSize || depth >= maxDepth / 2) {
+        nodes[index].count = end - begin;
+        return index;
+    }
+
+    uint32_t middle = begin + (end - begin) / 2;
+    if (node.right - node.left >= node.bottom - node.top) {
+        std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+                         [](const Item& a, const Item& b) { return a.left + a.right < b.left + b.right; });
+    } else {
+        std::nth_element(items.begin() + begin, items.begin() + middle, items.begin() + end,
+                         [](const Item& a, const Item& b) { return a.top + a.bottom < b.top + b.bottom; });
+    }
+
+    buildRange(begin, middle, depth + 1);
+    uint32_t right = buildRange(middle, end, depth + 1);
+    nodes[index].offset = right;
+    return index;
+}
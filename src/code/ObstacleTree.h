@@ -0,0 +1,127 @@
+/**
+ * @file ObstacleTree.h
+ * @brief Static bounding-volume hierarchy over the obstacles of an environment.
+ *
+ * Obstacles do not move while the simulation runs, so the hierarchy is built once when the simulation starts and is
+ * only rebuilt after an obstacle is added, removed or edited. Area and segment queries then visit O(log M) nodes
+ * instead of every obstacle.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef OBSTACLETREE_H
+#define OBSTACLETREE_H
+
+#include "Obstacle.h"
+#include "Collision.h"
+#include "QRectF"
+#include "vector"
+#include "memory"
+#include "cstdint"
+
+/**
+ * @class ObstacleTree
+ * @brief Binary BVH with axis-aligned boxes, stored as a flat array of nodes.
+ *
+ * The tree is built top-down by splitting the obstacles at the median of the longest axis. Children of an inner node
+ * are stored at index+1 (left) and at the stored offset (right), leaves reference a contiguous range of items.
+ * The obstacle bounds are copied into the items, so queries never call back into Obstacle. Queries do not modify
+ * the tree and may run concurrently.
+ */
+class ObstacleTree {
+public:
+    /**
+     * @brief A leaf entry: the bounds of one obstacle and the obstacle itself.
+     */
+    struct Item {
+        double left, top, right, bottom; ///< Bounds of the obstacle.
+        Obstacle* obstacle; ///< The obstacle these bounds belong to.
+    };
+
+    /**
+     * @brief Rebuilds the hierarchy from a set of obstacles.
+     * @param obstacles Obstacles to index.
+     */
+    void build(const std::vector<std::unique_ptr<Obstacle>>& obstacles);
+
+    /**
+     * @brief Calls a function for every obstacle whose bounds overlap an area.
+     * @param area Area of interest.
+     * @param fn Callable taking a const Item& and returning true to stop the search.
+     * @return True if the search was stopped by the callable.
+     */
+    template <typename Fn>
+    bool forEachInArea(const QRectF& area, Fn&& fn) const {
+        return traverse([&](double left, double top, double right, double bottom) {
+            return left <= area.right() && right >= area.left() && top <= area.bottom() && bottom >= area.top();
+        }, fn);
+    }
+
+    /**
+     * @brief Calls a function for every obstacle whose bounds, grown by a margin, touch a line segment.
+     * @param x1 x-coordinate of the start of the segment.
+     * @param y1 y-coordinate of the start of the segment.
+     * @param x2 x-coordinate of the end of the segment.
+     * @param y2 y-coordinate of the end of the segment.
+     * @param margin Distance by which every box is grown before testing it, typically the robot radius.
+     * @param fn Callable taking a const Item& and returning true to stop the search.
+     * @return True if the search was stopped by the callable.
+     */
+    template <typename Fn>
+    bool forEachAlongSegment(double x1, double y1, double x2, double y2, double margin, Fn&& fn) const {
+        return traverse([&](double left, double top, double right, double bottom) {
+            return Collision::segmentTouchesBox(x1, y1, x2, y2, left - margin, top - margin, right + margin, bottom + margin);
+        }, fn);
+    }
+
+    [[nodiscard]] bool isEmpty() const { return nodes.empty(); } /// True if the tree holds no obstacles.
+
+private:
+    /**
+     * @brief A node of the hierarchy. Leaves have count > 0, inner nodes store their right child in offset.
+     */
+    struct Node {
+        double left, top, right, bottom; ///< Bounds of everything below this node.
+        uint32_t offset; ///< First item of a leaf, or index of the right child of an inner node.
+        uint32_t count; ///< Number of items in a leaf, zero for inner nodes.
+    };
+
+    static constexpr uint32_t leafSize = 4; ///< Largest number of items stored in one leaf.
+    static constexpr int maxDepth = 64; ///< Size of the traversal stack.
+
+    std::vector<Node> nodes; ///< Nodes in depth-first order, the root is nodes[0].
+    std::vector<Item> items; ///< Items, grouped by leaf.
+
+    uint32_t buildRange(uint32_t begin, uint32_t end, int depth); /// Builds the subtree over items[begin, end).
+
+    template <typename Test, typename Fn>
+    bool traverse(Test&& test, Fn& fn) const {
+        if (nodes.empty()) {
+            return false;
+        }
+        uint32_t stack[maxDepth];
+        int top = 0;
+        stack[top++] = 0;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            if (!test(node.left, node.top, node.right, node.bottom)) {
+                continue;
+            }
+            if (node.count > 0) {
+                for (uint32_t i = node.offset; i < node.offset + node.count; ++i) {
+                    const Item& item = items[i];
+                    if (test(item.left, item.top, item.right, item.bottom) && fn(item)) {
+                        return true;
+                    }
+                }
+            } else {
+                stack[top++] = node.offset;
+                stack[top++] = static_cast<uint32_t>(&node - nodes.data()) + 1;
+            }
+        }
+        return false;
+    }
+};
+
+#endif // OBSTACLETREE_H
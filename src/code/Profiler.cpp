@@ -0,0 +1,421 @@
+/**
+ * @file Profiler.cpp
+ * @brief Implements the phase profiler declared in Profiler.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "Profiler.h"
+#include "algorithm"
+#include "cstdio"
+#include "fstream"
+
+/**
+ * @brief Lease of a ring by the current thread, returned when the thread ends.
+ */
+struct ProfilerRingLease {
+    Profiler::Ring* ring = nullptr; ///< The leased ring, or nullptr before the thread's first span.
+    uint32_t thread = 0; ///< Number of the thread in traces, or 0 before it is first needed.
+
+    ~ProfilerRingLease() {
+        if (ring) {
+            ring->owned.store(false, std::memory_order_release);
+        }
+    }
+};
+
+namespace {
+
+thread_local ProfilerRingLease lease; ///< Ring of the current thread.
+std::atomic<uint32_t> threadCount{0}; ///< Threads numbered so far.
+
+} // namespace
+
+/**
+ * @brief Gets the process-wide profiler.
+ * @return The profiler.
+ */
+Profiler& Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+/**
+ * @brief Hands a free ring, or a new one, to the calling thread.
+ * @return The ring, owned by the calling thread until it ends.
+ */
+Profiler::Ring* Profiler::acquireRing() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& ring : rings) {
+        bool expected = false;
+        if (ring->owned.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+            return ring.get();
+        }
+    }
+    rings.push_back(std::make_unique<Ring>());
+    rings.back()->owned.store(true, std::memory_order_relaxed);
+    return rings.back().get();
+}
+
+/**
+ * @brief Gets the number of the calling thread, assigning the next free one on first use.
+ * @return Number from 1, kept for the lifetime of the thread.
+ */
+uint32_t Profiler::threadNumber() {
+    if (lease.thread == 0) {
+        lease.thread = threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
+    return lease.thread;
+}
+
+/**
+ * @brief Names the calling thread in traces.
+ * @param name Name shown for the thread, for example "worker 2".
+ */
+void Profiler::setThreadName(const std::string& name) {
+    uint32_t thread = threadNumber() & 0xFFFF;
+    Profiler& profiler = instance();
+    std::lock_guard<std::mutex> lock(profiler.mutex);
+    profiler.threadNames[thread] = name;
+}
+
+/**
+ * @brief Appends a span to the calling thread's ring.
+ * @param phase Phase the span belongs to.
+ * @param start Start of the span, from now().
+ * @param end End of the span, from now().
+ *
+ * The slot is written before the head is advanced with release order, so a collector that sees the new head also
+ * sees the span.
+ */
+void Profiler::record(ProfilePhase phase, int64_t start, int64_t end) {
+    if (!lease.ring) {
+        lease.ring = instance().acquireRing();
+    }
+    Ring& ring = *lease.ring;
+    uint64_t head = ring.head.load(std::memory_order_relaxed);
+    Slot& slot = ring.entries[head & (ringCapacity - 1)];
+    auto duration = std::min(static_cast<uint64_t>(std::max<int64_t>(0, end - start)), maxDuration);
+    uint64_t thread = threadNumber() & 0xFFFF;
+    slot.start.store(start, std::memory_order_relaxed);
+    slot.packed.store(duration << durationShift | thread << 8 | static_cast<uint64_t>(phase), std::memory_order_relaxed);
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+/**
+ * @brief Drains the rings of all threads into the histograms, and into the trace while one is running.
+ *
+ * Spans are copied first and checked afterwards: once the head has moved a whole ring past a span, the writer may
+ * have been overwriting its slot while it was copied, so it is counted as dropped instead.
+ */
+void Profiler::collect() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pending.clear();
+    for (auto& ring : rings) {
+        uint64_t head = ring->head.load(std::memory_order_acquire);
+        if (head - ring->tail > ringCapacity) {
+            dropped += head - ring->tail - ringCapacity;
+            ring->tail = head - ringCapacity;
+        }
+        uint64_t first = ring->tail;
+        size_t offset = pending.size();
+        for (uint64_t i = first; i < head; ++i) {
+            const Slot& slot = ring->entries[i & (ringCapacity - 1)];
+            pending.push_back(Span{slot.start.load(std::memory_order_relaxed), slot.packed.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        uint64_t reachedHead = ring->head.load(std::memory_order_relaxed);
+        /// The writer of span reachedHead may already be writing the slot of span reachedHead - capacity.
+        uint64_t firstIntact = reachedHead >= ringCapacity ? reachedHead - ringCapacity + 1 : 0;
+        size_t kept = offset;
+        for (uint64_t i = first; i < head; ++i) {
+            const Span span = pending[offset + static_cast<size_t>(i - first)];
+            auto phase = static_cast<size_t>(span.packed & 0xFF);
+            if (i < firstIntact) {
+                ++dropped;
+                continue;
+            }
+            if (phase >= histograms.size()) {
+                continue;
+            }
+            uint64_t duration = span.packed >> durationShift;
+            Histogram& histogram = histograms[phase];
+            ++histogram.buckets[bucketOf(duration)];
+            ++histogram.count;
+            histogram.totalNanoseconds += duration;
+            histogram.maxNanoseconds = std::max(histogram.maxNanoseconds, duration);
+            pending[kept++] = span;
+        }
+        pending.resize(kept);
+        ring->tail = head;
+    }
+
+    if (!traceRunning) {
+        return;
+    }
+    /// Rings are drained one after another, so the spans of all threads are merged by start before they are traced.
+    std::sort(pending.begin(), pending.end(), [](const Span& a, const Span& b) { return a.start < b.start; });
+    for (const Span& span : pending) {
+        if (span.start < traceStart) {
+            continue;
+        }
+        trace.push_back(span);
+        if (static_cast<ProfilePhase>(span.packed & 0xFF) == ProfilePhase::Tick) {
+            traceTicks.push_back(span.start);
+        }
+    }
+    trimTrace();
+}
+
+/**
+ * @brief Drops the oldest trace spans until the trace is within its limits.
+ *
+ * Each collect() merges its spans by start, but a span collected late, such as a long tick recorded when it ends,
+ * may start before spans of the previous collect(). The window therefore ends roughly, not exactly, at a tick.
+ */
+void Profiler::trimTrace() {
+    if (traceLimits.ticks > 0 && traceTicks.size() > traceLimits.ticks) {
+        traceTicks.erase(traceTicks.begin(), traceTicks.end() - static_cast<std::ptrdiff_t>(traceLimits.ticks));
+        int64_t cutoff = traceTicks.front();
+        while (!trace.empty() && trace.front().start < cutoff) {
+            trace.pop_front();
+        }
+    }
+    if (traceLimits.spans > 0 && trace.size() > traceLimits.spans) {
+        trace.erase(trace.begin(), trace.end() - static_cast<std::ptrdiff_t>(traceLimits.spans));
+    }
+}
+
+/**
+ * @brief Gets the latency summary of every phase, as of the last collect().
+ * @return One entry per phase, indexed by ProfilePhase.
+ */
+std::array<Profiler::PhaseStats, static_cast<size_t>(ProfilePhase::Count)> Profiler::statistics() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::array<PhaseStats, static_cast<size_t>(ProfilePhase::Count)> result;
+    for (size_t phase = 0; phase < histograms.size(); ++phase) {
+        const Histogram& histogram = histograms[phase];
+        if (histogram.count == 0) {
+            continue;
+        }
+        result[phase].count = histogram.count;
+        result[phase].mean = histogram.totalNanoseconds / 1000.0 / static_cast<double>(histogram.count);
+        result[phase].p50 = percentile(histogram, 0.50) / 1000.0;
+        result[phase].p95 = percentile(histogram, 0.95) / 1000.0;
+        result[phase].p99 = percentile(histogram, 0.99) / 1000.0;
+        result[phase].max = histogram.maxNanoseconds / 1000.0;
+    }
+    return result;
+}
+
+/**
+ * @brief Gets the number of spans lost because a ring filled up before it was collected.
+ * @return Lost spans since the last reset.
+ */
+uint64_t Profiler::droppedSpans() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return dropped;
+}
+
+/**
+ * @brief Clears the histograms and discards spans not collected yet, except into a running trace.
+ */
+void Profiler::reset() {
+    if (tracing()) {
+        collect();
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& ring : rings) {
+        ring->tail = ring->head.load(std::memory_order_acquire);
+    }
+    histograms = {};
+    dropped = 0;
+}
+
+/**
+ * @brief Collects and formats the latency summary of every phase that has spans, one line per phase.
+ * @param linePrefix Text put in front of every line, for example "# " for comment lines.
+ * @return The table.
+ */
+std::string Profiler::report(const std::string& linePrefix) {
+    collect();
+    auto stats = statistics();
+    char line[160];
+    std::snprintf(line, sizeof(line), "%-13s %9s %10s %10s %10s %10s %10s\n", "phase", "count", "mean_us", "p50_us", "p95_us", "p99_us", "max_us");
+    std::string text = linePrefix + line;
+    for (size_t phase = 0; phase < stats.size(); ++phase) {
+        const PhaseStats& entry = stats[phase];
+        if (entry.count == 0) {
+            continue;
+        }
+        std::snprintf(line, sizeof(line), "%-13s %9llu %10.1f %10.1f %10.1f %10.1f %10.1f\n", phaseName(static_cast<ProfilePhase>(phase)),
+                      static_cast<unsigned long long>(entry.count), entry.mean, entry.p50, entry.p95, entry.p99, entry.max);
+        text += linePrefix + line;
+    }
+    uint64_t lost = droppedSpans();
+    if (lost > 0) {
+        text += linePrefix + "dropped spans: " + std::to_string(lost) + "\n";
+    }
+    return text;
+}
+
+/**
+ * @brief Starts a trace, discarding the spans of any previous one, and switches recording on.
+ * @param limits Window the trace keeps.
+ */
+void Profiler::startTrace(const TraceLimits& limits) {
+    std::lock_guard<std::mutex> lock(mutex);
+    traceRunning = true;
+    traceLimits = limits;
+    traceStart = now();
+    trace.clear();
+    traceTicks.clear();
+    active.fetch_or(traceUser, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Collects the last spans and stops the trace. Its spans are kept until the next startTrace().
+ */
+void Profiler::stopTrace() {
+    collect();
+    std::lock_guard<std::mutex> lock(mutex);
+    traceRunning = false;
+    active.fetch_and(~traceUser, std::memory_order_relaxed);
+}
+
+/**
+ * @brief Checks whether a trace is running.
+ * @return True between startTrace() and stopTrace().
+ */
+bool Profiler::tracing() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return traceRunning;
+}
+
+/**
+ * @brief Collects and writes the spans of the current or last trace as Chrome trace-event JSON.
+ * @param path Path of the file to create or overwrite.
+ * @param error Receives the reason if the file cannot be written.
+ * @return True on success.
+ *
+ * Every span becomes a complete ("X") event with times in microseconds from the start of the trace. Named threads
+ * get a thread_name metadata event, so chrome://tracing and Perfetto label their tracks.
+ */
+bool Profiler::writeTrace(const std::string& path, std::string& error) {
+    collect();
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "Unable to open file: " + path;
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    std::string buffer = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+                         "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"robot simulator\"}}";
+    char line[192];
+    for (const auto& [thread, name] : threadNames) {
+        buffer += ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(thread)
+                  + ",\"args\":{\"name\":\"" + name + "\"}}";
+    }
+    for (const Span& span : trace) {
+        auto phase = static_cast<ProfilePhase>(span.packed & 0xFF);
+        std::snprintf(line, sizeof(line), ",\n{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%u,\"ts\":%.3f,\"dur\":%.3f}",
+                      phaseName(phase), phaseCategory(phase), static_cast<unsigned>((span.packed >> 8) & 0xFFFF),
+                      static_cast<double>(span.start - traceStart) / 1000.0, static_cast<double>(span.packed >> durationShift) / 1000.0);
+        buffer += line;
+        if (buffer.size() >= (1 << 20)) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    }
+    buffer += "\n]}\n";
+    out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+    out.close();
+    if (!out) {
+        error = "Unable to write file: " + path;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Gets the display name of a phase.
+ * @param phase The phase.
+ * @return Name in lower case, without spaces.
+ */
+const char* Profiler::phaseName(ProfilePhase phase) {
+    switch (phase) {
+        case ProfilePhase::Tick: return "tick";
+        case ProfilePhase::RemoteInput: return "remote_input";
+        case ProfilePhase::SpatialIndex: return "spatial_index";
+        case ProfilePhase::Sensing: return "sensing";
+        case ProfilePhase::Movement: return "movement";
+        case ProfilePhase::Chunk: return "chunk";
+        case ProfilePhase::GuiEmit: return "gui_emit";
+        case ProfilePhase::SceneUpdate: return "scene_update";
+        case ProfilePhase::ConfigLoad: return "config_load";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Gets the trace category of a phase, by which trace viewers can filter.
+ * @param phase The phase.
+ * @return "gui" for GUI-thread work, "io" for loading and "simulation" for the rest.
+ */
+const char* Profiler::phaseCategory(ProfilePhase phase) {
+    switch (phase) {
+        case ProfilePhase::SceneUpdate: return "gui";
+        case ProfilePhase::ConfigLoad: return "io";
+        default: return "simulation";
+    }
+}
+
+/**
+ * @brief Gets the histogram bucket of a duration.
+ * @param nanoseconds The duration.
+ * @return Bucket index: durations below 16 ns have a bucket each, longer ones share eight per power of two.
+ */
+int Profiler::bucketOf(uint64_t nanoseconds) {
+    if (nanoseconds < 16) {
+        return static_cast<int>(nanoseconds);
+    }
+    int exponent = 63 - __builtin_clzll(nanoseconds);
+    int sub = static_cast<int>(nanoseconds >> (exponent - 3)) & (subBuckets - 1);
+    return std::min(bucketCount - 1, 16 + (exponent - 4) * subBuckets + sub);
+}
+
+/**
+ * @brief Gets the representative duration of a bucket.
+ * @param bucket Bucket index.
+ * @return The middle of the bucket's range, in nanoseconds.
+ */
+double Profiler::bucketValue(int bucket) {
+    if (bucket < 16) {
+        return bucket;
+    }
+    int exponent = (bucket - 16) / subBuckets + 4;
+    int sub = (bucket - 16) % subBuckets;
+    double width = static_cast<double>(uint64_t(1) << (exponent - 3));
+    return (subBuckets + sub) * width + width / 2;
+}
+
+/**
+ * @brief Gets the duration below which a share of the spans lie.
+ * @param histogram Histogram of the phase; must hold at least one span.
+ * @param fraction Share between 0 and 1.
+ * @return The duration in nanoseconds, never more than the longest span.
+ */
+double Profiler::percentile(const Histogram& histogram, double fraction) {
+    auto rank = static_cast<uint64_t>(fraction * static_cast<double>(histogram.count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int bucket = 0; bucket < bucketCount; ++bucket) {
+        seen += histogram.buckets[bucket];
+        if (seen >= rank) {
+            return std::min(bucketValue(bucket), static_cast<double>(histogram.maxNanoseconds));
+        }
+    }
+    return static_cast<double>(histogram.maxNanoseconds);
+}
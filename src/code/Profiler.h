@@ -0,0 +1,304 @@
+/**
+ * @file Profiler.h
+ * @brief Low-overhead phase profiler with per-thread ring buffers, latency histograms and timeline traces.
+ *
+ * Phases of a tick and of a GUI frame are timed by scope objects and appended to a ring owned by the recording
+ * thread, so recording takes two clock reads and no lock. A collector drains every ring now and then and folds the
+ * spans into one histogram per phase, from which the p50, p95 and p99 latencies are read. While a trace is running,
+ * the collector also keeps the spans themselves, which can be written as Chrome trace-event JSON and opened in
+ * chrome://tracing or Perfetto.
+ *
+ * Build with ROBOT_SIM_PROFILING=0 (for example `qmake DEFINES+=ROBOT_SIM_PROFILING=0`) to compile every
+ * PROFILE_SCOPE out; the instrumented code is then the same as without the profiler.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "atomic"
+#include "array"
+#include "deque"
+#include "map"
+#include "chrono"
+#include "memory"
+#include "mutex"
+#include "string"
+#include "vector"
+#include "cstddef"
+#include "cstdint"
+
+#ifndef ROBOT_SIM_PROFILING
+#define ROBOT_SIM_PROFILING 1
+#endif
+
+/**
+ * @brief Timed phases of the simulation.
+ */
+enum class ProfilePhase : uint8_t {
+    Tick, ///< One whole SimulationEngine::step.
+    RemoteInput, ///< Draining the command queue for remote-controlled robots.
+    SpatialIndex, ///< Rebuilding the spatial index and the obstacle tree.
+    Sensing, ///< Sensing of autonomous robots; Parallel mode only, Sequential mode counts it as Movement.
+    Movement, ///< Moving every robot.
+    Chunk, ///< One work-stealing chunk of robots, on whichever worker ran it; Parallel mode only.
+    GuiEmit, ///< Copying the environment into a render snapshot and notifying the GUI.
+    SceneUpdate, ///< Rebuilding the GUI scene from a snapshot, on the GUI thread.
+    ConfigLoad, ///< Reading a configuration file or snapshot into the environment.
+    Count ///< Number of phases.
+};
+
+/**
+ * @class Profiler
+ * @brief Collects phase spans from every thread and aggregates them into latency histograms.
+ *
+ * Each recording thread owns a single-producer ring of spans. A ring outlives its thread and is handed to the next
+ * thread that starts recording, so threads that come and go, such as scheduler workers, do not leak rings. The
+ * collector reads a ring without stopping its writer: it copies the spans between its read position and the
+ * writer's head, then discards any the writer may have overwritten meanwhile.
+ *
+ * Histograms are log-linear: eight buckets per power of two of nanoseconds, so a percentile is exact to within
+ * about six percent at every scale.
+ *
+ * A trace keeps a rolling window of spans bounded by a number of ticks and a number of spans, so it can stay on in
+ * long runs: the oldest spans are discarded as new ones are collected. Spans only reach the trace when they are
+ * collected, so a long-running trace must be collected at least once per ring's worth of spans.
+ */
+class Profiler {
+public:
+    static constexpr bool compiledIn = ROBOT_SIM_PROFILING != 0; ///< False if the scopes are compiled out.
+
+    /**
+     * @brief Latency summary of one phase since the last reset, in microseconds.
+     */
+    struct PhaseStats {
+        uint64_t count = 0; ///< Number of spans.
+        double mean = 0.0; ///< Mean duration.
+        double p50 = 0.0; ///< Median duration.
+        double p95 = 0.0; ///< 95th percentile.
+        double p99 = 0.0; ///< 99th percentile.
+        double max = 0.0; ///< Longest span.
+    };
+
+    /**
+     * @brief Bounds of the window a trace keeps.
+     */
+    struct TraceLimits {
+        size_t ticks = 1000; ///< Spans from before the latest this many ticks are discarded; 0 keeps every tick.
+        size_t spans = size_t(1) << 20; ///< At most this many spans are kept, 16 bytes each; 0 keeps every span.
+    };
+
+    /**
+     * @brief Gets the process-wide profiler.
+     * @return The profiler.
+     */
+    static Profiler& instance();
+
+    /**
+     * @brief Checks whether spans are being recorded. Cheap enough for every scope.
+     * @return True while recording is switched on.
+     */
+    static bool enabled() { return active.load(std::memory_order_relaxed) != 0; }
+
+    /**
+     * @brief Switches recording for the histograms on or off at run time. Spans already recorded are kept.
+     * @param on True to record.
+     *
+     * A running trace keeps recording switched on regardless.
+     */
+    static void setEnabled(bool on) {
+        if (on) {
+            active.fetch_or(statisticsUser, std::memory_order_relaxed);
+        } else {
+            active.fetch_and(~statisticsUser, std::memory_order_relaxed);
+        }
+    }
+
+    /**
+     * @brief Names the calling thread in traces.
+     * @param name Name shown for the thread, for example "worker 2".
+     */
+    static void setThreadName(const std::string& name);
+
+    /**
+     * @brief Reads the clock used for spans.
+     * @return Nanoseconds since an arbitrary, fixed epoch.
+     */
+    static int64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    /**
+     * @brief Appends a span to the calling thread's ring.
+     * @param phase Phase the span belongs to.
+     * @param start Start of the span, from now().
+     * @param end End of the span, from now().
+     */
+    static void record(ProfilePhase phase, int64_t start, int64_t end);
+
+    /**
+     * @brief Drains the rings of all threads into the histograms.
+     *
+     * Safe from any thread; concurrent collectors take turns.
+     */
+    void collect();
+
+    /**
+     * @brief Gets the latency summary of every phase, as of the last collect().
+     * @return One entry per phase, indexed by ProfilePhase.
+     */
+    [[nodiscard]] std::array<PhaseStats, static_cast<size_t>(ProfilePhase::Count)> statistics() const;
+
+    /**
+     * @brief Gets the number of spans lost because a ring filled up before it was collected.
+     * @return Lost spans since the last reset.
+     */
+    [[nodiscard]] uint64_t droppedSpans() const;
+
+    /**
+     * @brief Clears the histograms and discards spans not collected yet, except into a running trace.
+     */
+    void reset();
+
+    /**
+     * @brief Collects and formats the latency summary of every phase that has spans, one line per phase.
+     * @param linePrefix Text put in front of every line, for example "# " for comment lines.
+     * @return The table.
+     */
+    std::string report(const std::string& linePrefix = "");
+
+    /**
+     * @brief Starts a trace, discarding the spans of any previous one, and switches recording on.
+     * @param limits Window the trace keeps.
+     */
+    void startTrace(const TraceLimits& limits);
+
+    /**
+     * @brief Collects the last spans and stops the trace. Its spans are kept until the next startTrace().
+     */
+    void stopTrace();
+
+    /**
+     * @brief Checks whether a trace is running.
+     * @return True between startTrace() and stopTrace().
+     */
+    [[nodiscard]] bool tracing() const;
+
+    /**
+     * @brief Collects and writes the spans of the current or last trace as Chrome trace-event JSON.
+     * @param path Path of the file to create or overwrite.
+     * @param error Receives the reason if the file cannot be written.
+     * @return True on success.
+     */
+    bool writeTrace(const std::string& path, std::string& error);
+
+    /**
+     * @brief Gets the display name of a phase.
+     * @param phase The phase.
+     * @return Name in lower case, without spaces.
+     */
+    static const char* phaseName(ProfilePhase phase);
+
+private:
+    static constexpr size_t ringCapacity = 1 << 16; ///< Spans per ring; a power of two.
+    static constexpr int subBuckets = 8; ///< Histogram buckets per power of two.
+    static constexpr int bucketCount = 16 + 40 * subBuckets; ///< Exact buckets below 16 ns, then up to 2^44 ns.
+    static constexpr unsigned statisticsUser = 1; ///< Bit of active set by setEnabled().
+    static constexpr unsigned traceUser = 2; ///< Bit of active set while a trace runs.
+    static constexpr int durationShift = 24; ///< Position of the duration in a packed span.
+    static constexpr uint64_t maxDuration = (uint64_t(1) << (64 - durationShift)) - 1; ///< Longest storable span, about 18 minutes.
+
+    /**
+     * @brief One span in a ring, stored as atomics so the collector may read while the owner writes.
+     */
+    struct Slot {
+        std::atomic<int64_t> start{0}; ///< Start of the span in nanoseconds.
+        std::atomic<uint64_t> packed{0}; ///< Duration in nanoseconds in the high 40 bits, thread in the next 16, phase in the low 8.
+    };
+
+    /**
+     * @brief A span kept by a trace, as stored in a ring.
+     */
+    struct Span {
+        int64_t start; ///< Start of the span in nanoseconds.
+        uint64_t packed; ///< Duration, thread and phase, packed as in a Slot.
+    };
+
+    /**
+     * @brief Ring of spans written by one thread at a time.
+     */
+    struct Ring {
+        std::unique_ptr<Slot[]> entries{new Slot[ringCapacity]}; ///< The spans.
+        std::atomic<uint64_t> head{0}; ///< Number of spans ever written; advanced by the owner after each span.
+        uint64_t tail = 0; ///< Number of spans ever collected; touched by the collector only.
+        std::atomic<bool> owned{false}; ///< Set while a thread records into the ring.
+    };
+
+    /**
+     * @brief Histogram and running totals of one phase.
+     */
+    struct Histogram {
+        std::array<uint64_t, bucketCount> buckets{}; ///< Span counts per duration bucket.
+        uint64_t count = 0; ///< Number of spans.
+        uint64_t totalNanoseconds = 0; ///< Sum of all durations.
+        uint64_t maxNanoseconds = 0; ///< Longest duration.
+    };
+
+    friend struct ProfilerRingLease;
+
+    Profiler() = default;
+    Ring* acquireRing(); ///< Hand a free ring, or a new one, to the calling thread.
+    void trimTrace(); ///< Drop the oldest trace spans until the trace is within its limits.
+    static uint32_t threadNumber(); ///< Number of the calling thread, assigned on first use.
+    static const char* phaseCategory(ProfilePhase phase); ///< Trace category of a phase.
+    static int bucketOf(uint64_t nanoseconds); ///< Histogram bucket of a duration.
+    static double bucketValue(int bucket); ///< Representative duration of a bucket, in nanoseconds.
+    static double percentile(const Histogram& histogram, double fraction); ///< Duration below which a share of the spans lie.
+
+    inline static std::atomic<unsigned> active{0}; ///< Recording switch read by every scope, one bit per user.
+    mutable std::mutex mutex; ///< Guards the ring list, the read positions and the histograms.
+    std::vector<std::unique_ptr<Ring>> rings; ///< Every ring ever handed out.
+    std::array<Histogram, static_cast<size_t>(ProfilePhase::Count)> histograms; ///< One histogram per phase.
+    uint64_t dropped = 0; ///< Spans overwritten before they were collected.
+    std::vector<Span> pending; ///< Spans copied out of a ring, reused by every collect().
+    bool traceRunning = false; ///< Set between startTrace() and stopTrace().
+    TraceLimits traceLimits; ///< Window of the running trace.
+    int64_t traceStart = 0; ///< Spans starting earlier are not traced.
+    std::deque<Span> trace; ///< Spans of the trace, roughly in order of their start.
+    std::deque<int64_t> traceTicks; ///< Starts of the traced ticks, in order.
+    std::map<uint32_t, std::string> threadNames; ///< Names of the threads, by number.
+};
+
+/**
+ * @class ProfileScope
+ * @brief Records the lifetime of the scope as a span of a phase, if the profiler is switched on at construction.
+ */
+class ProfileScope {
+public:
+    explicit ProfileScope(ProfilePhase phase) : phase(phase), start(Profiler::enabled() ? Profiler::now() : -1) {}
+    ~ProfileScope() {
+        if (start >= 0) {
+            Profiler::record(phase, start, Profiler::now());
+        }
+    }
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    ProfilePhase phase; ///< Phase of the span.
+    int64_t start; ///< Start of the span, or -1 if the profiler was off.
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if ROBOT_SIM_PROFILING
+/// Times the rest of the enclosing block as a span of a phase.
+#define PROFILE_SCOPE(phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(phase)
+#else
+#define PROFILE_SCOPE(phase) static_cast<void>(0)
+#endif
+
+#endif // PROFILER_H
@@ -14,6 +14,7 @@
 #include "QString"
 #include "QDebug"
 #include "Environment.h"
+#include "RobotCommand.h"
 
 /**
  * @class RemoteControlledRobot
@@ -21,7 +22,7 @@
  *
  * This class extends the Robot class and provides additional functionalities to control the robot's movement and orientation remotely.
  */
-class RemoteControlledRobot : public Robot {
+class RemoteControlledRobot final : public Robot {
 public:
     RemoteControlledRobot(int id, std::pair<double, double> position, double velocity, double orientation, double sensorRange, Environment* env);
 
@@ -34,7 +35,8 @@ public:
 
     void handleCollision() override;
     void rotate(double angle) override;
-    void processCommand(const QString &command);
+    void execute(const RobotCommand &command);
+    [[nodiscard]] int getGroup() const { return group; } /// Group the robot belongs to; commands may address a whole group.
     void move(double maxWidth, double maxHeight) override;
 
 private:
@@ -47,11 +49,9 @@ private:
     bool movingBackward = false;
     bool turningLeft = false;
     bool turningRight = false;
+    int group = 0; ///< Group number set by CommandOpcode::SetGroup.
 
-    bool canMoveTo(double x, double y, double maxWidth, double maxHeight);
     void updatePosition(double newX, double newY, double maxWidth, double maxHeight);
-    bool lineIntersectsRect(double x1, double y1, double x2, double y2, const QRectF& rect);
-    bool lineIntersectsLine(double x1, double y1, double x2, double y2, double x3, double y3, double x4, double y4);
 };
 
 #endif // REMOTECONTROLLEDROBOT_H
@@ -0,0 +1,54 @@
+/**
+ * @file RenderSnapshot.h
+ * @brief Plain copy of everything the GUI draws, published by the simulation once per frame.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef RENDERSNAPSHOT_H
+#define RENDERSNAPSHOT_H
+
+#include "QRectF"
+#include "vector"
+#include "RobotStore.h"
+#include "SlotMap.h"
+
+/**
+ * @brief Pose and parameters of one robot at the end of a frame.
+ */
+struct RobotPose {
+    int id; ///< Robot identifier.
+    SlotHandle handle; ///< Handle of the robot, which goes stale once the robot is removed.
+    RobotKind kind; ///< Type of the robot.
+    double x; ///< x-coordinate of the centre.
+    double y; ///< y-coordinate of the centre.
+    double orientation; ///< Orientation in degrees.
+    double speed; ///< Speed in units per tick.
+    double sensorRange; ///< Sensor range in units.
+};
+
+/**
+ * @brief Position and size of one obstacle.
+ */
+struct ObstaclePose {
+    int id; ///< Obstacle identifier.
+    SlotHandle handle; ///< Handle of the obstacle, which goes stale once the obstacle is removed.
+    QRectF bounds; ///< Bounding box of the obstacle.
+};
+
+/**
+ * @brief State of the whole environment at the end of a frame.
+ *
+ * Holds values only and no pointers into the environment, so the GUI can keep drawing it while the simulation
+ * thread changes or even deletes robots and obstacles.
+ */
+struct RenderSnapshot {
+    long long tick = 0; ///< Ticks simulated when the snapshot was taken.
+    unsigned long obstacleRevision = 0; ///< Changes whenever the obstacle list changes; equal revisions mean equal lists.
+    std::vector<RobotPose> robots; ///< One entry per robot, in slot order.
+    std::vector<ObstaclePose> obstacles; ///< One entry per obstacle.
+};
+
+#endif // RENDERSNAPSHOT_H
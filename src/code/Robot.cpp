@@ -14,19 +14,23 @@
 /**
  * @brief Constructor for the Robot class.
  * @param id Unique identifier for the robot.
+ * @param kind Type tag of the concrete robot class.
  * @param position Initial position of the robot as a pair (x, y).
  * @param velocity Initial speed of the robot.
  * @param orientation Initial orientation of the robot in degrees.
  * @param sensorRange Range of the sensors attached to the robot.
  */
-Robot::Robot(int id, std::pair<double, double> position, double velocity, double orientation, double sensorRange)
-    : id(id), velocity(velocity), orientation(orientation), sensorRange(sensorRange), position(position) {}
+Robot::Robot(int id, RobotKind kind, std::pair<double, double> position, double velocity, double orientation, double sensorRange)
+    : kind(kind), velocity(velocity), orientation(orientation), sensorRange(sensorRange), position(position), id(id) {}
 
 /**
 * @brief Get the current position of the robot.
 * @return A pair representing the x and y coordinates of the robot.
 */
 std::pair<double, double> Robot::getPosition() const {
+    if (store) {
+        return {store->x[slot], store->y[slot]};
+    }
     return position;
 }
 
@@ -35,7 +39,7 @@ std::pair<double, double> Robot::getPosition() const {
  * @return The speed of the robot.
  */
 double Robot::getSpeed() const {
-    return velocity;
+    return store ? store->speeds[slot] : velocity;
 }
 
 /**
@@ -43,7 +47,7 @@ double Robot::getSpeed() const {
  * @return The orientation of the robot.
  */
 double Robot::getOrientation() const {
-    return orientation;
+    return store ? store->headings[slot] : orientation;
 }
 
 /**
@@ -51,7 +55,7 @@ double Robot::getOrientation() const {
  * @return The sensor range in units.
  */
 double Robot::getRange() const {
-    return sensorRange;
+    return store ? store->sensorRanges[slot] : sensorRange;
 }
 
 /**
@@ -59,7 +63,8 @@ double Robot::getRange() const {
  * @param position A pair of double values representing the new position (x, y) of the robot.
  */
 void Robot::setPosition(const std::pair<double, double>& position) {
-    this->position = position;
+    posX() = position.first;
+    posY() = position.second;
 }
 
 /**
@@ -67,7 +72,7 @@ void Robot::setPosition(const std::pair<double, double>& position) {
  * @param speed The new speed of the robot.
  */
 void Robot::setSpeed(double speed) {
-    this->velocity = speed;
+    this->speed() = speed;
 }
 
 /**
@@ -75,7 +80,7 @@ void Robot::setSpeed(double speed) {
  * @param orientation The new orientation of the robot in degrees.
  */
 void Robot::setOrientation(double orientation) {
-    this->orientation = orientation;
+    heading() = orientation;
 }
 
 /**
@@ -83,7 +88,7 @@ void Robot::setOrientation(double orientation) {
  * @param sensorSize The new size of the sensor range.
  */
 void Robot::setSensorSize(double sensorSize) {
-    this->sensorRange = sensorSize;
+    range() = sensorSize;
 }
 
 /**
@@ -93,3 +98,30 @@ void Robot::setSensorSize(double sensorSize) {
 bool Robot::isTaskCompleted() const {
     return taskCompleted;
 }
+
+/**
+ * @brief Bind the robot to a slot of a component store.
+ * @param store The store that holds the robot's state from now on.
+ * @param slot The slot assigned to the robot.
+ *
+ * The store is expected to have been filled with the robot's current state already (see RobotStore::add); this
+ * only redirects the accessors. It is also used to update the slot after the store has moved the robot.
+ */
+void Robot::attach(RobotStore* store, size_t slot) {
+    this->store = store;
+    this->slot = slot;
+}
+
+/**
+ * @brief Copy the robot's state out of its store and stop using the store.
+ */
+void Robot::detach() {
+    if (!store) {
+        return;
+    }
+    position = {store->x[slot], store->y[slot]};
+    orientation = store->headings[slot];
+    velocity = store->speeds[slot];
+    sensorRange = store->sensorRanges[slot];
+    store = nullptr;
+}
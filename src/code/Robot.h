@@ -13,6 +13,7 @@
 #include "cmath"
 #include "iostream"
 #include "QRectF"
+#include "RobotStore.h"
 
 class Robot {
 
@@ -20,12 +21,13 @@ public:
     /**
  * @brief Constructor for Robot class that initializes a new Robot instance.
  * @param id Unique identifier for the robot.
+ * @param kind Type tag of the concrete robot class.
  * @param position Initial position of the robot represented as a pair (x-coordinate, y-coordinate).
  * @param velocity Initial velocity of the robot.
  * @param orientation Initial orientation of the robot in degrees.
  * @param sensorRange Range of the sensors attached to the robot.
  */
-    Robot(int id, std::pair<double, double> position, double velocity, double orientation, double sensorRange);
+    Robot(int id, RobotKind kind, std::pair<double, double> position, double velocity, double orientation, double sensorRange);
     /**
  * @brief Virtual destructor for Robot class.
  */
@@ -52,6 +54,12 @@ public:
 
     [[nodiscard]] int getID() const { return id; }
 
+    /**
+ * @brief Get the type tag of the robot.
+ * @return The kind of the concrete robot class.
+ */
+    [[nodiscard]] RobotKind getKind() const { return kind; }
+
     /**
  * @brief Check if the robot has completed its assigned task.
  * @return True if the task is completed, otherwise false.
@@ -77,7 +85,7 @@ public:
  * @brief Set a new speed for the robot.
  * @param speed The new speed in units per second.
  */
-    [[nodiscard]] double getSensorRange() const {return sensorRange;}
+    [[nodiscard]] double getSensorRange() const { return getRange(); }
 
     void setSpeed(double speed);
     /**
@@ -102,13 +110,39 @@ public:
 
     [[nodiscard]] std::pair<double, double> getPosition() const;
 
+    /**
+ * @brief Bind the robot to a slot of a component store, moving its state into the store.
+ * @param store The store that holds the robot's state from now on.
+ * @param slot The slot assigned to the robot.
+ */
+    void attach(RobotStore* store, size_t slot);
+    /**
+ * @brief Copy the robot's state out of its store and stop using the store.
+ */
+    void detach();
+    /**
+ * @brief Get the slot of the robot in its component store.
+ * @return The slot index; only meaningful while the robot is attached.
+ */
+    [[nodiscard]] size_t getSlot() const { return slot; }
+
 private:
     bool taskCompleted = false; ///< Indicates whether the robot's current task has been completed.
+    RobotKind kind; ///< Type tag of the concrete robot class.
+    RobotStore* store = nullptr; ///< Component store holding the robot's state, or nullptr while detached.
+    size_t slot = 0; ///< Slot of the robot in the store.
+    double velocity; ///< Speed of the robot while detached.
+    double orientation; ///< Orientation of the robot in degrees while detached.
+    double sensorRange; ///< Range of the sensors while detached.
+    std::pair<double, double> position; ///< Position of the robot while detached.
 
 protected:
     int id; ///< Unique identifier for the robot.
-    double velocity; ///< Current speed of the robot.
-    double orientation; ///< Current orientation of the robot in degrees.
-    double sensorRange; ///< Range of the sensors equipped on the robot.
-    std::pair<double, double> position; ///< Current position of the robot as (x, y) coordinates.
+
+    double& posX() { return store ? store->x[slot] : position.first; } ///< x-coordinate of the robot.
+    double& posY() { return store ? store->y[slot] : position.second; } ///< y-coordinate of the robot.
+    double& heading() { return store ? store->headings[slot] : orientation; } ///< Orientation of the robot in degrees.
+    double& speed() { return store ? store->speeds[slot] : velocity; } ///< Speed of the robot.
+    double& range() { return store ? store->sensorRanges[slot] : sensorRange; } ///< Range of the robot's sensors.
+    [[nodiscard]] const RobotStore* getStore() const { return store; } ///< Store the robot is attached to, if any.
 };
@@ -0,0 +1,85 @@
+/**
+ * @file RobotCommand.h
+ * @brief Binary command addressed to one remote-controlled robot, a group of them, or all of them.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef ROBOTCOMMAND_H
+#define ROBOTCOMMAND_H
+
+#include "cstdint"
+
+/**
+ * @brief What a command tells a remote-controlled robot to do.
+ */
+enum class CommandOpcode : uint8_t {
+    StartMoveForward, ///< Drive forward at the robot's speed until stopped.
+    StopMoveForward, ///< Stop driving forward.
+    StartMoveBackward, ///< Drive backward at the robot's speed until stopped.
+    StopMoveBackward, ///< Stop driving backward.
+    StartTurnLeft, ///< Turn left every tick until stopped.
+    StopTurnLeft, ///< Stop turning left.
+    StartTurnRight, ///< Turn right every tick until stopped.
+    StopTurnRight, ///< Stop turning right.
+    SetSpeed, ///< Set the speed to the payload, in units per tick.
+    SetGroup ///< Move the robot into the group given by the payload.
+};
+
+/**
+ * @brief Which robots a command is for.
+ */
+enum class CommandTarget : uint8_t {
+    Robot, ///< The remote-controlled robot whose identifier is targetId.
+    Group, ///< Every remote-controlled robot in group targetId.
+    All ///< Every remote-controlled robot.
+};
+
+/**
+ * @brief One command for remote-controlled robots.
+ *
+ * A plain value of a few bytes, so producers on any thread can queue it without allocating and the simulation can
+ * dispatch it with a switch instead of comparing strings.
+ */
+struct RobotCommand {
+    CommandOpcode opcode = CommandOpcode::StopMoveForward; ///< What to do.
+    CommandTarget target = CommandTarget::All; ///< Which robots to address.
+    int targetId = 0; ///< Robot identifier or group number, depending on target.
+    double value = 0.0; ///< Payload of SetSpeed and SetGroup; unused by the other opcodes.
+
+    /**
+     * @brief Builds a command for every remote-controlled robot.
+     * @param opcode What to do.
+     * @param value Payload, if the opcode takes one.
+     * @return The command.
+     */
+    static RobotCommand toAll(CommandOpcode opcode, double value = 0.0) {
+        return RobotCommand{opcode, CommandTarget::All, 0, value};
+    }
+
+    /**
+     * @brief Builds a command for a single robot.
+     * @param id Identifier of the robot.
+     * @param opcode What to do.
+     * @param value Payload, if the opcode takes one.
+     * @return The command.
+     */
+    static RobotCommand toRobot(int id, CommandOpcode opcode, double value = 0.0) {
+        return RobotCommand{opcode, CommandTarget::Robot, id, value};
+    }
+
+    /**
+     * @brief Builds a command for a group of robots.
+     * @param group Group number, as set by SetGroup.
+     * @param opcode What to do.
+     * @param value Payload, if the opcode takes one.
+     * @return The command.
+     */
+    static RobotCommand toGroup(int group, CommandOpcode opcode, double value = 0.0) {
+        return RobotCommand{opcode, CommandTarget::Group, group, value};
+    }
+};
+
+#endif // ROBOTCOMMAND_H
@@ -0,0 +1,163 @@
+/**
+ * @file RobotStore.cpp
+ * @brief Implements the robot component store declared in RobotStore.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "RobotStore.h"
+#include "Robot.h"
+
+/**
+ * @brief Appends a robot and attaches it to its new slot.
+ * @param robot Robot to add; its current state is copied into the columns.
+ * @return The slot assigned to the robot.
+ */
+size_t RobotStore::add(Robot* robot) {
+    size_t slot = size();
+    auto position = robot->getPosition();
+    ids.push_back(robot->getID());
+    kinds.push_back(robot->getKind());
+    x.push_back(position.first);
+    y.push_back(position.second);
+    headings.push_back(robot->getOrientation());
+    speeds.push_back(robot->getSpeed());
+    sensorRanges.push_back(robot->getRange());
+    handles.push_back(robot);
+    std::vector<uint32_t>& kindSlots = slotsOf(robot->getKind());
+    kindPositions.push_back(static_cast<uint32_t>(kindSlots.size()));
+    kindSlots.push_back(static_cast<uint32_t>(slot));
+    robot->attach(this, slot);
+    return slot;
+}
+
+/**
+ * @brief Appends a block of robots whose state is given as columns, without attaching any robot yet.
+ * @param count Number of robots.
+ * @param robotIds Identifiers.
+ * @param robotKinds Type tags.
+ * @param robotX x-coordinates.
+ * @param robotY y-coordinates.
+ * @param robotHeadings Orientations in degrees.
+ * @param robotSpeeds Speeds.
+ * @param robotSensorRanges Sensor ranges.
+ * @return The slot of the first robot of the block.
+ */
+size_t RobotStore::append(size_t count, const int* robotIds, const RobotKind* robotKinds, const double* robotX, const double* robotY,
+                          const double* robotHeadings, const double* robotSpeeds, const double* robotSensorRanges) {
+    size_t first = size();
+    ids.insert(ids.end(), robotIds, robotIds + count);
+    kinds.insert(kinds.end(), robotKinds, robotKinds + count);
+    x.insert(x.end(), robotX, robotX + count);
+    y.insert(y.end(), robotY, robotY + count);
+    headings.insert(headings.end(), robotHeadings, robotHeadings + count);
+    speeds.insert(speeds.end(), robotSpeeds, robotSpeeds + count);
+    sensorRanges.insert(sensorRanges.end(), robotSensorRanges, robotSensorRanges + count);
+    handles.resize(first + count, nullptr);
+    kindPositions.resize(first + count);
+    for (size_t slot = first; slot < first + count; ++slot) {
+        std::vector<uint32_t>& kindSlots = slotsOf(kinds[slot]);
+        kindPositions[slot] = static_cast<uint32_t>(kindSlots.size());
+        kindSlots.push_back(static_cast<uint32_t>(slot));
+    }
+    return first;
+}
+
+/**
+ * @brief Attaches a robot to a slot created by append().
+ * @param slot The slot.
+ * @param robot Robot taking the slot.
+ */
+void RobotStore::bind(size_t slot, Robot* robot) {
+    handles[slot] = robot;
+    robot->attach(this, slot);
+}
+
+/**
+ * @brief Reserves room for a number of robots in every column.
+ * @param count Total number of robots to make room for.
+ */
+void RobotStore::reserve(size_t count) {
+    ids.reserve(count);
+    kinds.reserve(count);
+    x.reserve(count);
+    y.reserve(count);
+    headings.reserve(count);
+    speeds.reserve(count);
+    sensorRanges.reserve(count);
+    handles.reserve(count);
+    kindPositions.reserve(count);
+}
+
+/**
+ * @brief Removes the robot in a slot by moving the robot in the last slot into it.
+ * @param slot Slot to remove.
+ *
+ * The removed robot gets its state back before the columns shrink, and the moved robot is told its new slot. Only
+ * one slot changes owner, so removal costs the same wherever the robot sits. The kind lists are patched the same
+ * way: the removed slot is swapped out of its list, and the entry of the moved robot is renumbered.
+ */
+void RobotStore::remove(size_t slot) {
+    handles[slot]->detach();
+    size_t last = size() - 1;
+
+    std::vector<uint32_t>& kindSlots = slotsOf(kinds[slot]);
+    uint32_t position = kindPositions[slot];
+    kindSlots[position] = kindSlots.back();
+    kindPositions[kindSlots[position]] = position;
+    kindSlots.pop_back();
+
+    if (slot != last) {
+        slotsOf(kinds[last])[kindPositions[last]] = static_cast<uint32_t>(slot);
+        kindPositions[slot] = kindPositions[last];
+        ids[slot] = ids[last];
+        kinds[slot] = kinds[last];
+        x[slot] = x[last];
+        y[slot] = y[last];
+        headings[slot] = headings[last];
+        speeds[slot] = speeds[last];
+        sensorRanges[slot] = sensorRanges[last];
+        handles[slot] = handles[last];
+        handles[slot]->attach(this, slot);
+    }
+    ids.pop_back();
+    kinds.pop_back();
+    x.pop_back();
+    y.pop_back();
+    headings.pop_back();
+    speeds.pop_back();
+    sensorRanges.pop_back();
+    handles.pop_back();
+    kindPositions.pop_back();
+}
+
+/**
+ * @brief Removes all robots, handing every robot its state back first.
+ */
+void RobotStore::clear() {
+    for (Robot* robot : handles) {
+        robot->detach();
+    }
+    ids.clear();
+    kinds.clear();
+    x.clear();
+    y.clear();
+    headings.clear();
+    speeds.clear();
+    sensorRanges.clear();
+    handles.clear();
+    autonomousSlots.clear();
+    remoteSlots.clear();
+    kindPositions.clear();
+}
+
+/**
+ * @brief Freezes the current positions; until releaseSnapshot, robots see each other at these positions.
+ */
+void RobotStore::takeSnapshot() {
+    snapshotX.assign(x.begin(), x.end());
+    snapshotY.assign(y.begin(), y.end());
+    snapshotTaken = true;
+}
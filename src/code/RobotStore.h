@@ -0,0 +1,128 @@
+/**
+ * @file RobotStore.h
+ * @brief Contiguous structure-of-arrays storage for the state of all robots in an environment.
+ *
+ * Per-tick loops (movement, sensing, collision checks, index rebuilds) only need a few scalars per robot. Keeping
+ * each of them in its own array lets those loops stream through memory instead of chasing one heap object per robot.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef ROBOTSTORE_H
+#define ROBOTSTORE_H
+
+#include "vector"
+#include "cstddef"
+#include "cstdint"
+
+class Robot;
+
+/**
+ * @brief Type tag of a robot, stored next to its state so loops can branch without RTTI.
+ */
+enum class RobotKind : uint8_t {
+    Autonomous, ///< AutonomousRobot.
+    Remote ///< RemoteControlledRobot.
+};
+
+/**
+ * @class RobotStore
+ * @brief Structure-of-arrays component store for robot state.
+ *
+ * Slot i of every column belongs to the same robot, and slots are kept in the same order as the owning
+ * Environment's robot list. The Robot objects act as handles: once attached, their getters and setters read and
+ * write the columns of their slot.
+ *
+ * The slots of each kind are also kept in their own index list, so a loop that only concerns one kind walks that
+ * list with no tag test per robot, and the handles it reads can be cast to the concrete class without RTTI.
+ */
+class RobotStore {
+public:
+    std::vector<int> ids; ///< Robot identifiers.
+    std::vector<RobotKind> kinds; ///< Type tags.
+    std::vector<double> x; ///< x-coordinates of the robot centres.
+    std::vector<double> y; ///< y-coordinates of the robot centres.
+    std::vector<double> headings; ///< Orientations in degrees.
+    std::vector<double> speeds; ///< Speeds in units per tick.
+    std::vector<double> sensorRanges; ///< Sensor ranges in units.
+    std::vector<Robot*> handles; ///< The robot object owning each slot.
+    std::vector<double> snapshotX; ///< x-coordinates frozen at the start of a parallel tick.
+    std::vector<double> snapshotY; ///< y-coordinates frozen at the start of a parallel tick.
+    std::vector<uint32_t> autonomousSlots; ///< Slots holding an AutonomousRobot, in no particular order.
+    std::vector<uint32_t> remoteSlots; ///< Slots holding a RemoteControlledRobot, in no particular order.
+
+    /**
+     * @brief Appends a robot and attaches it to its new slot.
+     * @param robot Robot to add; its current state is copied into the columns.
+     * @return The slot assigned to the robot.
+     */
+    size_t add(Robot* robot);
+
+    /**
+     * @brief Appends a block of robots whose state is given as columns, without attaching any robot yet.
+     * @param count Number of robots.
+     * @param robotIds Identifiers.
+     * @param robotKinds Type tags.
+     * @param robotX x-coordinates.
+     * @param robotY y-coordinates.
+     * @param robotHeadings Orientations in degrees.
+     * @param robotSpeeds Speeds.
+     * @param robotSensorRanges Sensor ranges.
+     * @return The slot of the first robot of the block; the others follow it.
+     *
+     * Each column is copied in one block. The handles of the new slots are null until bind() is called for each.
+     */
+    size_t append(size_t count, const int* robotIds, const RobotKind* robotKinds, const double* robotX, const double* robotY,
+                  const double* robotHeadings, const double* robotSpeeds, const double* robotSensorRanges);
+
+    /**
+     * @brief Attaches a robot to a slot created by append().
+     * @param slot The slot.
+     * @param robot Robot taking the slot; its own state is ignored in favour of the slot's.
+     */
+    void bind(size_t slot, Robot* robot);
+
+    /**
+     * @brief Reserves room for a number of robots in every column.
+     * @param count Total number of robots to make room for.
+     */
+    void reserve(size_t count);
+
+    /**
+     * @brief Removes the robot in a slot by moving the robot in the last slot into it.
+     * @param slot Slot to remove.
+     */
+    void remove(size_t slot);
+
+    /**
+     * @brief Removes all robots.
+     */
+    void clear();
+
+    /**
+     * @brief Freezes the current positions; until releaseSnapshot, robots see each other at these positions.
+     *
+     * Each robot still writes its own position into x and y, so robots updated in any order or in parallel all see
+     * the state of the previous tick.
+     */
+    void takeSnapshot();
+
+    /**
+     * @brief Lets robots see each other's live positions again.
+     */
+    void releaseSnapshot() { snapshotTaken = false; }
+
+    [[nodiscard]] const double* observedX() const { return snapshotTaken ? snapshotX.data() : x.data(); } /// x-coordinates other robots are seen at.
+    [[nodiscard]] const double* observedY() const { return snapshotTaken ? snapshotY.data() : y.data(); } /// y-coordinates other robots are seen at.
+    [[nodiscard]] size_t size() const { return ids.size(); } /// Number of robots in the store.
+    [[nodiscard]] const std::vector<uint32_t>& slotsOf(RobotKind kind) const { return kind == RobotKind::Remote ? remoteSlots : autonomousSlots; } /// Slots of all robots of a kind.
+
+private:
+    std::vector<uint32_t>& slotsOf(RobotKind kind) { return kind == RobotKind::Remote ? remoteSlots : autonomousSlots; } /// Mutable slot list of a kind.
+
+    std::vector<uint32_t> kindPositions; ///< Position of each slot within the slot list of its kind.
+    bool snapshotTaken = false; ///< True between takeSnapshot and releaseSnapshot.
+};
+
+#endif // ROBOTSTORE_H
@@ -0,0 +1,558 @@
+/**
+ * @file SceneGenerator.cpp
+ * @brief Implements the procedural scene generator declared in SceneGenerator.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "SceneGenerator.h"
+#include "algorithm"
+#include "charconv"
+#include "climits"
+#include "cmath"
+#include "cstdio"
+#include "fstream"
+#include "random"
+#include "vector"
+
+namespace {
+
+/**
+ * @brief Source of every random choice of the generator.
+ *
+ * std::mt19937_64 produces the same sequence on every standard library, unlike the standard distributions, so
+ * numbers are derived from its raw output by hand and a seed gives the same scene everywhere.
+ */
+class Random {
+public:
+    explicit Random(uint64_t seed) : engine(seed) {}
+
+    double uniform() { return static_cast<double>(engine() >> 11) * 0x1.0p-53; } /// Number in [0, 1).
+    double uniform(double low, double high) { return low + (high - low) * uniform(); } /// Number in [low, high).
+    size_t below(size_t bound) { return static_cast<size_t>(engine() % bound); } /// Integer in [0, bound).
+
+private:
+    std::mt19937_64 engine; ///< Underlying generator.
+};
+
+/**
+ * @brief Rounds a coordinate to hundredths, so text and binary output of a scene hold the same values.
+ * @param value Value to round.
+ * @return The rounded value.
+ */
+double roundCoordinate(double value) {
+    return std::round(value * 100.0) / 100.0;
+}
+
+/**
+ * @brief Appends a square obstacle, numbered after the ones before it.
+ * @param scene Scene to append to.
+ * @param x x-coordinate of the centre.
+ * @param y y-coordinate of the centre.
+ * @param size Edge length.
+ */
+void addBlock(SceneConfig& scene, double x, double y, double size) {
+    int id = static_cast<int>(scene.obstacles.size()) + 1;
+    scene.obstacles.push_back({0, id, roundCoordinate(x), roundCoordinate(y), roundCoordinate(size)});
+}
+
+/**
+ * @brief Lays out double-sided racks of six blocks in a grid, with aisles four blocks wide around each rack.
+ * @param spec Parameters of the scene.
+ * @param scene Scene receiving the racks.
+ */
+void layOutWarehouse(const SceneSpec& spec, SceneConfig& scene) {
+    const double block = spec.spacing;
+    const double aisle = 4 * block;
+    const int rackLength = 6;
+    const int rackDepth = 2;
+    for (double top = aisle; top + rackDepth * block + aisle <= scene.height; top += rackDepth * block + aisle) {
+        for (double left = aisle; left + rackLength * block + aisle <= scene.width; left += rackLength * block + aisle) {
+            for (int row = 0; row < rackDepth; ++row) {
+                for (int column = 0; column < rackLength; ++column) {
+                    addBlock(scene, left + (column + 0.5) * block, top + (row + 0.5) * block, block);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief Scatters obstacles of half to one and a half blocks until they cover the requested share of the world.
+ * @param spec Parameters of the scene.
+ * @param scene Scene receiving the obstacles.
+ * @param random Source of positions and sizes.
+ *
+ * Obstacles may overlap each other, so the covered share is an upper bound.
+ */
+void layOutClutter(const SceneSpec& spec, SceneConfig& scene, Random& random) {
+    const double meanArea = spec.spacing * spec.spacing * 13.0 / 12.0; /// E[size^2] for size uniform in [0.5, 1.5] blocks.
+    auto count = static_cast<size_t>(std::llround(spec.clutter * scene.width * scene.height / meanArea));
+    scene.obstacles.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        double size = random.uniform(0.5, 1.5) * spec.spacing;
+        double x = random.uniform(size / 2, scene.width - size / 2);
+        double y = random.uniform(size / 2, scene.height - size / 2);
+        addBlock(scene, x, y, size);
+    }
+}
+
+/**
+ * @brief Lays out walls across the whole width, one block thick and four blocks apart.
+ * @param spec Parameters of the scene.
+ * @param scene Scene receiving the walls.
+ * @param random Source of doorway positions.
+ *
+ * Every wall has a doorway three blocks wide per thirty blocks of length, and at least one, so every corridor is
+ * reachable from the next.
+ */
+void layOutCorridors(const SceneSpec& spec, SceneConfig& scene, Random& random) {
+    const double block = spec.spacing;
+    const double corridor = 4 * block;
+    const int doorway = 3;
+    auto blocksPerWall = static_cast<size_t>(scene.width / block);
+    if (blocksPerWall < doorway + 1) {
+        return;
+    }
+    std::vector<char> open(blocksPerWall);
+    for (double top = corridor; top + block + corridor <= scene.height; top += block + corridor) {
+        std::fill(open.begin(), open.end(), 0);
+        size_t doorways = std::max<size_t>(1, blocksPerWall / 30);
+        for (size_t i = 0; i < doorways; ++i) {
+            size_t start = random.below(blocksPerWall - doorway + 1);
+            std::fill(open.begin() + start, open.begin() + start + doorway, 1);
+        }
+        for (size_t column = 0; column < blocksPerWall; ++column) {
+            if (!open[column]) {
+                addBlock(scene, (column + 0.5) * block, top + block / 2, block);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Carves a perfect maze with passages three blocks wide and builds its walls from blocks.
+ * @param spec Parameters of the scene.
+ * @param scene Scene receiving the walls.
+ * @param random Source of the carving order.
+ *
+ * Maze cells are four blocks apart: three blocks of passage and one of wall. The maze is carved by a depth-first
+ * search with an explicit stack, which stays flat on mazes of millions of cells, and is centred in the world.
+ */
+void layOutMaze(const SceneSpec& spec, SceneConfig& scene, Random& random) {
+    const double block = spec.spacing;
+    const int pitch = 4;
+    auto columns = static_cast<size_t>((scene.width / block - 1) / pitch);
+    auto rows = static_cast<size_t>((scene.height / block - 1) / pitch);
+    if (columns == 0 || rows == 0) {
+        return;
+    }
+
+    /// eastOpen and southOpen record the carved walls on the east and south side of every cell.
+    std::vector<char> visited(columns * rows), eastOpen(columns * rows), southOpen(columns * rows);
+    std::vector<size_t> stack {random.below(columns * rows)};
+    visited[stack.back()] = 1;
+    while (!stack.empty()) {
+        size_t cell = stack.back();
+        size_t column = cell % columns;
+        size_t row = cell / columns;
+        /// Each candidate remembers which wall it opens: 0 east of it, 1 east of this cell, 2 south of it, 3 south of this cell.
+        size_t neighbours[4];
+        int walls[4];
+        int count = 0;
+        if (column > 0 && !visited[cell - 1]) { neighbours[count] = cell - 1; walls[count++] = 0; }
+        if (column + 1 < columns && !visited[cell + 1]) { neighbours[count] = cell + 1; walls[count++] = 1; }
+        if (row > 0 && !visited[cell - columns]) { neighbours[count] = cell - columns; walls[count++] = 2; }
+        if (row + 1 < rows && !visited[cell + columns]) { neighbours[count] = cell + columns; walls[count++] = 3; }
+        if (count == 0) {
+            stack.pop_back();
+            continue;
+        }
+        size_t pick = random.below(static_cast<size_t>(count));
+        size_t next = neighbours[pick];
+        switch (walls[pick]) {
+            case 0: eastOpen[next] = 1; break;
+            case 1: eastOpen[cell] = 1; break;
+            case 2: southOpen[next] = 1; break;
+            default: southOpen[cell] = 1; break;
+        }
+        visited[next] = 1;
+        stack.push_back(next);
+    }
+
+    /// Blocks are indexed on a grid of pitch * cells + 1 per side; walls lie on multiples of the pitch.
+    double left = (scene.width - (pitch * columns + 1) * block) / 2;
+    double top = (scene.height - (pitch * rows + 1) * block) / 2;
+    auto place = [&](size_t blockColumn, size_t blockRow) {
+        addBlock(scene, left + (blockColumn + 0.5) * block, top + (blockRow + 0.5) * block, block);
+    };
+    for (size_t row = 0; row <= rows; ++row) {
+        for (size_t column = 0; column <= columns; ++column) {
+            place(column * pitch, row * pitch);
+            /// Wall segment to the east of the post, closing the north side of the cell below it.
+            bool northClosed = column < columns && (row == 0 || row == rows || !southOpen[(row - 1) * columns + column]);
+            /// Wall segment to the south of the post, closing the west side of the cell to its right.
+            bool westClosed = row < rows && (column == 0 || column == columns || !eastOpen[row * columns + column - 1]);
+            for (int i = 1; i < pitch; ++i) {
+                if (northClosed) place(column * pitch + i, row * pitch);
+                if (westClosed) place(column * pitch, row * pitch + i);
+            }
+        }
+    }
+}
+
+/**
+ * @brief Obstacles bucketed on a uniform grid, each grown by the clearance a robot needs around its centre.
+ *
+ * Buckets are stored as one index array with offsets per cell, so millions of obstacles need two allocations.
+ */
+class ObstacleGrid {
+public:
+    /**
+     * @brief Buckets the obstacles of a scene.
+     * @param scene Scene holding the obstacles.
+     * @param clearance Distance a robot centre must keep from every obstacle.
+     */
+    ObstacleGrid(const SceneConfig& scene, double clearance) : scene(scene), clearance(clearance) {
+        double largest = 0.0;
+        for (const ObstacleConfig& obstacle : scene.obstacles) {
+            largest = std::max(largest, obstacle.size);
+        }
+        cell = std::max(largest + 2 * clearance, 1.0);
+        columns = static_cast<size_t>(scene.width / cell) + 1;
+        rows = static_cast<size_t>(scene.height / cell) + 1;
+
+        offsets.assign(columns * rows + 1, 0);
+        forEachCell([&](size_t cellIndex, uint32_t) { ++offsets[cellIndex + 1]; });
+        for (size_t i = 1; i < offsets.size(); ++i) {
+            offsets[i] += offsets[i - 1];
+        }
+        items.resize(offsets.back());
+        std::vector<uint32_t> fill(offsets.begin(), offsets.end() - 1);
+        forEachCell([&](size_t cellIndex, uint32_t obstacle) { items[fill[cellIndex]++] = obstacle; });
+    }
+
+    /**
+     * @brief Checks whether a robot centred at a point would touch an obstacle.
+     * @param x x-coordinate of the robot centre.
+     * @param y y-coordinate of the robot centre.
+     * @return True if the point lies within the clearance of an obstacle.
+     */
+    [[nodiscard]] bool blocked(double x, double y) const {
+        size_t cellIndex = cellOf(y, rows) * columns + cellOf(x, columns);
+        for (uint32_t i = offsets[cellIndex]; i < offsets[cellIndex + 1]; ++i) {
+            const ObstacleConfig& obstacle = scene.obstacles[items[i]];
+            double reach = obstacle.size / 2 + clearance;
+            if (std::abs(x - obstacle.x) < reach && std::abs(y - obstacle.y) < reach) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    /**
+     * @brief Grid coordinate of a world coordinate, clamped to the grid.
+     * @param value World coordinate.
+     * @param count Number of cells along the axis.
+     * @return Cell coordinate.
+     */
+    [[nodiscard]] size_t cellOf(double value, size_t count) const {
+        return std::min(count - 1, static_cast<size_t>(std::max(0.0, value / cell)));
+    }
+
+    /**
+     * @brief Calls a visitor for every cell touched by every grown obstacle.
+     * @param visit Called with the cell index and the obstacle index.
+     */
+    template <typename Visit>
+    void forEachCell(Visit&& visit) const {
+        for (size_t i = 0; i < scene.obstacles.size(); ++i) {
+            const ObstacleConfig& obstacle = scene.obstacles[i];
+            double reach = obstacle.size / 2 + clearance;
+            size_t firstColumn = cellOf(obstacle.x - reach, columns), lastColumn = cellOf(obstacle.x + reach, columns);
+            size_t firstRow = cellOf(obstacle.y - reach, rows), lastRow = cellOf(obstacle.y + reach, rows);
+            for (size_t row = firstRow; row <= lastRow; ++row) {
+                for (size_t column = firstColumn; column <= lastColumn; ++column) {
+                    visit(row * columns + column, static_cast<uint32_t>(i));
+                }
+            }
+        }
+    }
+
+    const SceneConfig& scene; ///< Scene holding the obstacles.
+    double clearance; ///< Growth of every obstacle.
+    double cell = 1.0; ///< Edge of a grid cell; no grown obstacle is larger.
+    size_t columns = 1; ///< Cells per row.
+    size_t rows = 1; ///< Rows of cells.
+    std::vector<uint32_t> offsets; ///< Start of every cell's bucket in items, plus the end of the last one.
+    std::vector<uint32_t> items; ///< Obstacle indices, bucket after bucket.
+};
+
+/**
+ * @brief Fills the free space of a scene with points no closer than a minimum distance (Bridson's algorithm).
+ * @param scene Scene whose size bounds the points.
+ * @param obstacles Obstacles the points must keep clear of.
+ * @param margin Distance the points keep from the border of the world.
+ * @param distance Minimum distance between two points.
+ * @param random Source of the samples.
+ * @param points Receives the points, ordered row by row of the sampling grid so neighbours stay close in memory.
+ *
+ * Each accepted point tries up to twelve candidates in the annulus between one and two distances around it. When
+ * no active point is left, fresh seeds are thrown at random until many in a row fail, which reaches areas a wall
+ * cuts off from the first seed.
+ */
+void sampleFreeSpace(const SceneConfig& scene, const ObstacleGrid& obstacles, double margin, double distance, Random& random,
+                     std::vector<std::pair<double, double>>& points) {
+    const int attempts = 12;
+    const int seedFailures = 64;
+    const double cell = distance / std::sqrt(2.0);
+    const double low = margin;
+    const double highX = scene.width - margin;
+    const double highY = scene.height - margin;
+    auto columns = static_cast<size_t>((highX - low) / cell) + 1;
+    auto rows = static_cast<size_t>((highY - low) / cell) + 1;
+
+    /// Every cell of the sampling grid holds at most one point, since its diagonal equals the minimum distance. The
+    /// grid stores the point itself rather than an index, so testing a neighbour touches one cache line; an x of -1
+    /// marks an empty cell.
+    std::vector<std::pair<double, double>> grid(columns * rows, {-1.0, 0.0});
+    std::vector<std::pair<double, double>> active;
+    auto accept = [&](double x, double y) {
+        if (x < low || x > highX || y < low || y > highY) {
+            return false;
+        }
+        size_t column = std::min(columns - 1, static_cast<size_t>((x - low) / cell));
+        size_t row = std::min(rows - 1, static_cast<size_t>((y - low) / cell));
+        if (grid[row * columns + column].first >= 0 || obstacles.blocked(x, y)) {
+            return false;
+        }
+        /// The corners of the 5 x 5 neighbourhood lie more than one distance away from any point of the centre cell.
+        for (size_t r = row >= 2 ? row - 2 : 0; r <= std::min(rows - 1, row + 2); ++r) {
+            bool edgeRow = r + 2 == row || r == row + 2;
+            for (size_t c = column >= 2 ? column - 2 : 0; c <= std::min(columns - 1, column + 2); ++c) {
+                if (edgeRow && (c + 2 == column || c == column + 2)) {
+                    continue;
+                }
+                const auto& other = grid[r * columns + c];
+                double dx = other.first - x;
+                double dy = other.second - y;
+                if (other.first >= 0 && dx * dx + dy * dy < distance * distance) {
+                    return false;
+                }
+            }
+        }
+        grid[row * columns + column] = {x, y};
+        active.emplace_back(x, y);
+        return true;
+    };
+
+    points.clear();
+    if (highX < low || highY < low) {
+        return;
+    }
+    for (int failures = 0; failures < seedFailures;) {
+        failures = accept(random.uniform(low, highX), random.uniform(low, highY)) ? 0 : failures + 1;
+        /// The newest active point is expanded first, so the front grows through neighbouring cells and the grid
+        /// accesses stay local; Bridson's algorithm allows any order.
+        while (!active.empty()) {
+            auto [x, y] = active.back();
+            bool placed = false;
+            for (int i = 0; i < attempts && !placed; ++i) {
+                /// Rejection sampling keeps the annulus free of trigonometry, whose last bits vary between libraries.
+                double dx, dy, squared;
+                do {
+                    dx = random.uniform(-2.0, 2.0) * distance;
+                    dy = random.uniform(-2.0, 2.0) * distance;
+                    squared = dx * dx + dy * dy;
+                } while (squared < distance * distance || squared > 4 * distance * distance);
+                placed = accept(x + dx, y + dy);
+            }
+            if (!placed) {
+                active.pop_back();
+            }
+        }
+    }
+
+    for (const auto& point : grid) {
+        if (point.first >= 0) {
+            points.push_back(point);
+        }
+    }
+}
+
+} // namespace
+
+/**
+ * @brief Generates a scene.
+ * @param spec Parameters of the scene.
+ * @param scene Receives the size, robots and obstacles; robots and obstacles are numbered from 1.
+ * @param error Receives the reason if the scene cannot be generated.
+ * @return False if the parameters are invalid or the robots do not fit into the free space.
+ *
+ * Robots are placed last. The sampling distance starts where the free space holds a fifth more points than
+ * robots, so a random subset of the samples is spread over the whole world; it shrinks towards touching robots
+ * until enough samples fit.
+ */
+bool SceneGenerator::generate(const SceneSpec& spec, SceneConfig& scene, std::string& error) {
+    const double minimumDistance = 2 * spec.robotRadius + 1.0;
+    if (spec.robots > static_cast<size_t>(INT_MAX) || !(spec.density > 0) || spec.width < 0 || spec.height < 0
+        || !(spec.remoteFraction >= 0 && spec.remoteFraction <= 1) || !(spec.clutter >= 0 && spec.clutter <= 0.9)
+        || !(spec.robotRadius > 0) || !(spec.speed >= 0) || !(spec.sensorRange >= 0)) {
+        error = "Invalid scene parameters";
+        return false;
+    }
+    if (!(3 * spec.spacing >= minimumDistance)) {
+        error = "Spacing too small: passages three blocks wide must fit a robot";
+        return false;
+    }
+
+    scene = SceneConfig();
+    double side = std::max(100.0 * std::sqrt(static_cast<double>(spec.robots) / spec.density), 20 * spec.spacing);
+    scene.width = roundCoordinate(spec.width > 0 ? spec.width : side);
+    scene.height = roundCoordinate(spec.height > 0 ? spec.height : (spec.width > 0 ? spec.width : side));
+
+    Random random(spec.seed);
+    switch (spec.layout) {
+        case SceneLayout::WarehouseGrid: layOutWarehouse(spec, scene); break;
+        case SceneLayout::RandomClutter: layOutClutter(spec, scene, random); break;
+        case SceneLayout::Corridor: layOutCorridors(spec, scene, random); break;
+        case SceneLayout::Maze: layOutMaze(spec, scene, random); break;
+    }
+    if (spec.robots == 0) {
+        return true;
+    }
+
+    /// Coordinates are rounded to hundredths afterwards, which the extra unit of clearance absorbs.
+    ObstacleGrid obstacles(scene, spec.robotRadius + 0.5);
+    double freeArea = scene.width * scene.height;
+    for (const ObstacleConfig& obstacle : scene.obstacles) {
+        freeArea -= obstacle.size * obstacle.size;
+    }
+    const double target = 1.2 * static_cast<double>(spec.robots);
+    double distance = std::max(minimumDistance, std::sqrt(0.55 * std::max(freeArea, 0.0) / target));
+    std::vector<std::pair<double, double>> points;
+    for (;;) {
+        sampleFreeSpace(scene, obstacles, spec.robotRadius + 0.5, distance, random, points);
+        if (points.size() >= spec.robots) {
+            break;
+        }
+        if (distance <= minimumDistance) {
+            error = "Only " + std::to_string(points.size()) + " of " + std::to_string(spec.robots) + " robots fit into the free space";
+            return false;
+        }
+        distance = std::max(minimumDistance, distance * 0.95 * std::sqrt(static_cast<double>(points.size()) / target));
+    }
+
+    /// A partial shuffle picks the robots; restoring grid order afterwards keeps neighbouring robots close in memory.
+    std::vector<uint32_t> chosen(points.size());
+    for (uint32_t i = 0; i < chosen.size(); ++i) {
+        chosen[i] = i;
+    }
+    for (size_t i = 0; i < spec.robots; ++i) {
+        std::swap(chosen[i], chosen[i + random.below(chosen.size() - i)]);
+    }
+    chosen.resize(spec.robots);
+    std::sort(chosen.begin(), chosen.end());
+
+    scene.robots.reserve(spec.robots);
+    for (size_t i = 0; i < spec.robots; ++i) {
+        RobotConfig robot {};
+        robot.id = static_cast<int>(i) + 1;
+        robot.kind = random.uniform() < spec.remoteFraction ? RobotKind::Remote : RobotKind::Autonomous;
+        robot.x = roundCoordinate(points[chosen[i]].first);
+        robot.y = roundCoordinate(points[chosen[i]].second);
+        robot.speed = roundCoordinate(spec.speed);
+        robot.orientation = roundCoordinate(random.uniform(0.0, 360.0));
+        robot.sensorRange = roundCoordinate(spec.sensorRange);
+        scene.robots.push_back(robot);
+    }
+    return true;
+}
+
+/**
+ * @brief Writes a scene in the text configuration format, starting with its Environment line.
+ * @param path Path of the file to create or overwrite.
+ * @param scene Scene to write.
+ * @param error Receives the reason if the file cannot be written.
+ * @return True on success.
+ *
+ * Lines are formatted into a buffer that is flushed every megabyte, which keeps a scene of millions of lines within
+ * a second or two; the values carry two decimals, as many as the generator keeps.
+ */
+bool SceneGenerator::writeText(const std::string& path, const SceneConfig& scene, std::string& error) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "Unable to open file: " + path;
+        return false;
+    }
+    std::string buffer;
+    buffer.reserve(2 << 20);
+    auto flush = [&](size_t threshold) {
+        if (buffer.size() >= threshold) {
+            out.write(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+            buffer.clear();
+        }
+    };
+    auto number = [&](double value) {
+        char text[32];
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+        size_t length = static_cast<size_t>(std::to_chars(text, text + sizeof(text), value, std::chars_format::fixed, 2).ptr - text);
+#else
+        size_t length = static_cast<size_t>(std::snprintf(text, sizeof(text), "%.2f", value));
+#endif
+        buffer += ' ';
+        buffer.append(text, length);
+    };
+
+    buffer += "# Generated scene: " + std::to_string(scene.robots.size()) + " robots, " + std::to_string(scene.obstacles.size()) + " obstacles\n";
+    buffer += "Environment";
+    number(scene.width);
+    number(scene.height);
+    buffer += '\n';
+    for (const RobotConfig& robot : scene.robots) {
+        buffer += robot.kind == RobotKind::Remote ? "Robot remote " : "Robot autonomous ";
+        buffer += std::to_string(robot.id);
+        number(robot.x);
+        number(robot.y);
+        number(robot.speed);
+        number(robot.orientation);
+        number(robot.sensorRange);
+        buffer += '\n';
+        flush(1 << 20);
+    }
+    for (const ObstacleConfig& obstacle : scene.obstacles) {
+        buffer += "Obstacle ";
+        buffer += std::to_string(obstacle.id);
+        number(obstacle.x);
+        number(obstacle.y);
+        number(obstacle.size);
+        buffer += '\n';
+        flush(1 << 20);
+    }
+    flush(0);
+
+    out.close();
+    if (!out) {
+        error = "Unable to write file: " + path;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parses the name of a layout.
+ * @param name warehouse, clutter, corridor or maze.
+ * @param layout Receives the layout.
+ * @return False for an unknown name.
+ */
+bool SceneGenerator::parseLayout(const std::string& name, SceneLayout& layout) {
+    if (name == "warehouse") layout = SceneLayout::WarehouseGrid;
+    else if (name == "clutter") layout = SceneLayout::RandomClutter;
+    else if (name == "corridor") layout = SceneLayout::Corridor;
+    else if (name == "maze") layout = SceneLayout::Maze;
+    else return false;
+    return true;
+}
@@ -0,0 +1,84 @@
+/**
+ * @file SceneGenerator.h
+ * @brief Procedural generator of large scenes for stress runs and benchmarks.
+ *
+ * Hand-written configurations stop at a handful of entities. The generator lays out obstacles as a warehouse, random
+ * clutter, parallel corridors or a maze, then scatters robots over the free space with Poisson-disk sampling, so no
+ * two robots overlap and no robot starts inside an obstacle. The same seed always yields the same scene.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef SCENEGENERATOR_H
+#define SCENEGENERATOR_H
+
+#include "cstddef"
+#include "cstdint"
+#include "string"
+#include "ConfigParser.h"
+
+/**
+ * @brief Obstacle layouts the generator can produce.
+ */
+enum class SceneLayout {
+    WarehouseGrid, ///< Double-sided racks in a regular grid, separated by aisles.
+    RandomClutter, ///< Obstacles of varying size scattered at random.
+    Corridor, ///< Parallel walls across the whole width, each with a few doorways.
+    Maze ///< A perfect maze of walls, with exactly one path between any two places.
+};
+
+/**
+ * @brief Parameters of a generated scene.
+ */
+struct SceneSpec {
+    SceneLayout layout = SceneLayout::RandomClutter; ///< Obstacle layout.
+    size_t robots = 1000; ///< Number of robots to place.
+    double width = 0.0; ///< Width of the world; 0 derives a square world from the robot count and density.
+    double height = 0.0; ///< Height of the world; 0 derives a square world from the robot count and density.
+    double density = 1.0; ///< Robots per 100 x 100 units of world, used when the size is derived.
+    double remoteFraction = 0.0; ///< Share of remote-controlled robots; the rest are autonomous.
+    double speed = 2.0; ///< Speed of every robot.
+    double sensorRange = 40.0; ///< Sensor range of every robot.
+    double spacing = 20.0; ///< Edge of one obstacle block; racks, walls and corridors are multiples of it.
+    double clutter = 0.15; ///< Share of the world covered by obstacles in RandomClutter.
+    double robotRadius = 11.0; ///< Radius kept free around every robot.
+    uint64_t seed = 1; ///< Seed of every random choice.
+};
+
+/**
+ * @class SceneGenerator
+ * @brief Builds scenes from a SceneSpec and writes them in the text configuration format.
+ *
+ * Binary output goes through SceneSnapshot::write, which takes the generated SceneConfig directly.
+ */
+class SceneGenerator {
+public:
+    /**
+     * @brief Generates a scene.
+     * @param spec Parameters of the scene.
+     * @param scene Receives the size, robots and obstacles; robots and obstacles are numbered from 1.
+     * @param error Receives the reason if the scene cannot be generated.
+     * @return False if the parameters are invalid or the robots do not fit into the free space.
+     */
+    static bool generate(const SceneSpec& spec, SceneConfig& scene, std::string& error);
+
+    /**
+     * @brief Writes a scene in the text configuration format, starting with its Environment line.
+     * @param path Path of the file to create or overwrite.
+     * @param scene Scene to write.
+     * @param error Receives the reason if the file cannot be written.
+     * @return True on success.
+     */
+    static bool writeText(const std::string& path, const SceneConfig& scene, std::string& error);
+
+    /**
+     * @brief Parses the name of a layout.
+     * @param name warehouse, clutter, corridor or maze.
+     * @param layout Receives the layout.
+     * @return False for an unknown name.
+     */
+    static bool parseLayout(const std::string& name, SceneLayout& layout);
+};
+
+#endif // SCENEGENERATOR_H
@@ -0,0 +1,242 @@
+/**
+ * @file SceneSnapshot.cpp
+ * @brief Implements the memory-mapped binary scene format declared in SceneSnapshot.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "SceneSnapshot.h"
+#include "Environment.h"
+#include "cstring"
+#include "fstream"
+#include "vector"
+
+namespace {
+
+constexpr char snapshotMagic[8] = {'R', 'S', 'I', 'M', 'S', 'C', 'N', '\0'}; ///< First bytes of every snapshot.
+constexpr uint32_t nativeByteOrder = 0x01020304; ///< Reads back unchanged only on a machine of the writer's byte order.
+
+/**
+ * @brief Rounds a byte offset up to the next multiple of 8.
+ * @param offset Offset to round.
+ * @return The rounded offset.
+ */
+uint64_t alignColumn(uint64_t offset) {
+    return (offset + 7) & ~uint64_t(7);
+}
+
+/**
+ * @brief Writes zero bytes up to the next multiple of 8.
+ * @param out Stream to write into.
+ */
+void padColumn(std::ofstream& out) {
+    static const char zeros[8] = {};
+    auto position = static_cast<uint64_t>(out.tellp());
+    out.write(zeros, static_cast<std::streamsize>(alignColumn(position) - position));
+}
+
+/**
+ * @brief Writes one column and pads it to the next multiple of 8 bytes.
+ * @param out Stream to write into.
+ * @param values First value of the column.
+ * @param count Number of values.
+ */
+template <typename T>
+void writeColumn(std::ofstream& out, const T* values, size_t count) {
+    out.write(reinterpret_cast<const char*>(values), static_cast<std::streamsize>(count * sizeof(T)));
+    padColumn(out);
+}
+
+} // namespace
+
+/**
+ * @brief Computes where each column starts for a given number of robots and obstacles.
+ * @param robots Number of robots.
+ * @param obstacles Number of obstacles.
+ * @param offsets Receives the offset of each column and, last, the size of the whole file.
+ */
+void SceneSnapshot::layout(uint64_t robots, uint64_t obstacles, uint64_t offsets[ColumnCount + 1]) {
+    const uint64_t widths[ColumnCount] = {sizeof(int32_t), sizeof(RobotKind), sizeof(double), sizeof(double), sizeof(double), sizeof(double), sizeof(double),
+                                          sizeof(int32_t), sizeof(double), sizeof(double), sizeof(double)};
+    uint64_t offset = sizeof(SceneSnapshotHeader);
+    for (int i = 0; i < ColumnCount; ++i) {
+        offsets[i] = offset;
+        offset = alignColumn(offset + widths[i] * (i < ObstacleIds ? robots : obstacles));
+    }
+    offsets[ColumnCount] = offset;
+}
+
+/**
+ * @brief Maps a snapshot file and checks that its header and size are consistent.
+ * @param path Path of the file.
+ * @param error Receives the reason if the file cannot be used.
+ * @return True if the columns may be read.
+ */
+bool SceneSnapshot::open(const std::string& path, std::string& error) {
+    if (!file.open(path, error)) {
+        return false;
+    }
+    if (file.size() < sizeof(SceneSnapshotHeader)) {
+        error = "Snapshot too short: " + path;
+        return false;
+    }
+
+    const SceneSnapshotHeader& head = header();
+    if (std::memcmp(head.magic, snapshotMagic, sizeof(snapshotMagic)) != 0) {
+        error = "Not a scene snapshot: " + path;
+        return false;
+    }
+    if (head.byteOrder != nativeByteOrder) {
+        error = "Snapshot was written on a machine of different byte order: " + path;
+        return false;
+    }
+    if (head.version != currentVersion) {
+        error = "Unsupported snapshot version " + std::to_string(head.version) + ": " + path;
+        return false;
+    }
+    /// Counts are bounded before the layout is computed, so a corrupt header cannot overflow the offsets.
+    if (head.robotCount > file.size() || head.obstacleCount > file.size()) {
+        error = "Corrupt snapshot header: " + path;
+        return false;
+    }
+    layout(head.robotCount, head.obstacleCount, offsets);
+    if (offsets[ColumnCount] > file.size()) {
+        error = "Truncated snapshot: " + path;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Checks whether a file starts with the snapshot magic, without mapping it.
+ * @param path Path of the file.
+ * @return True for a snapshot file of any version.
+ */
+bool SceneSnapshot::isSnapshot(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    char magic[sizeof(snapshotMagic)] = {};
+    return file.read(magic, sizeof(magic)) && std::memcmp(magic, snapshotMagic, sizeof(magic)) == 0;
+}
+
+/**
+ * @brief Writes a header and the columns it announces.
+ * @param path Path of the file to create or overwrite.
+ * @param width Width of the environment.
+ * @param height Height of the environment.
+ * @param robots Robot columns; the counts of both column sets go into the header.
+ * @param obstacles Obstacle columns.
+ * @param error Receives the reason if the file cannot be written.
+ * @return True on success.
+ */
+bool SceneSnapshot::writeColumns(const std::string& path, double width, double height, const RobotColumns& robots, const ObstacleColumns& obstacles, std::string& error) {
+    std::ofstream out(path, std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        error = "Unable to open file: " + path;
+        return false;
+    }
+
+    SceneSnapshotHeader head {};
+    std::memcpy(head.magic, snapshotMagic, sizeof(snapshotMagic));
+    head.version = currentVersion;
+    head.byteOrder = nativeByteOrder;
+    head.robotCount = robots.count;
+    head.obstacleCount = obstacles.count;
+    head.width = width;
+    head.height = height;
+    out.write(reinterpret_cast<const char*>(&head), sizeof(head));
+
+    writeColumn(out, robots.ids, robots.count);
+    writeColumn(out, robots.kinds, robots.count);
+    writeColumn(out, robots.x, robots.count);
+    writeColumn(out, robots.y, robots.count);
+    writeColumn(out, robots.headings, robots.count);
+    writeColumn(out, robots.speeds, robots.count);
+    writeColumn(out, robots.sensorRanges, robots.count);
+    writeColumn(out, obstacles.ids, obstacles.count);
+    writeColumn(out, obstacles.x, obstacles.count);
+    writeColumn(out, obstacles.y, obstacles.count);
+    writeColumn(out, obstacles.sizes, obstacles.count);
+
+    out.close();
+    if (!out) {
+        error = "Unable to write file: " + path;
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Writes the robots and obstacles of an environment as a snapshot file.
+ * @param path Path of the file to create or overwrite.
+ * @param environment Environment to write.
+ * @param error Receives the reason if the file cannot be written.
+ * @return True on success.
+ *
+ * Robot columns are written straight from the robot store; obstacles are gathered into columns first.
+ */
+bool SceneSnapshot::write(const std::string& path, Environment& environment, std::string& error) {
+    const RobotStore& store = environment.getRobotStore();
+    const auto& obstacles = environment.getObstacles();
+    std::vector<int32_t> robotIds(store.ids.begin(), store.ids.end());
+    RobotColumns robotColumns {store.size(), robotIds.data(), store.kinds.data(), store.x.data(), store.y.data(),
+                               store.headings.data(), store.speeds.data(), store.sensorRanges.data()};
+
+    std::vector<int32_t> obstacleIds;
+    std::vector<double> obstacleX, obstacleY, obstacleSizes;
+    obstacleIds.reserve(obstacles.size());
+    obstacleX.reserve(obstacles.size());
+    obstacleY.reserve(obstacles.size());
+    obstacleSizes.reserve(obstacles.size());
+    for (const auto& obstacle : obstacles) {
+        obstacleIds.push_back(obstacle->getId());
+        obstacleX.push_back(obstacle->getPosition().first);
+        obstacleY.push_back(obstacle->getPosition().second);
+        obstacleSizes.push_back(obstacle->getBounds().width());
+    }
+    ObstacleColumns obstacleColumns {obstacles.size(), obstacleIds.data(), obstacleX.data(), obstacleY.data(), obstacleSizes.data()};
+    return writeColumns(path, environment.width, environment.height, robotColumns, obstacleColumns, error);
+}
+
+/**
+ * @brief Writes a parsed or generated configuration as a snapshot file, without building an environment.
+ * @param path Path of the file to create or overwrite.
+ * @param config Configuration to write; its width and height must be set.
+ * @param error Receives the reason if the file cannot be written.
+ * @return True on success.
+ */
+bool SceneSnapshot::write(const std::string& path, const SceneConfig& config, std::string& error) {
+    if (!(config.width > 0) || !(config.height > 0)) {
+        error = "A snapshot needs the size of the environment: " + path;
+        return false;
+    }
+    size_t robotCount = config.robots.size();
+    std::vector<int32_t> robotIds(robotCount);
+    std::vector<RobotKind> kinds(robotCount);
+    std::vector<double> x(robotCount), y(robotCount), headings(robotCount), speeds(robotCount), sensorRanges(robotCount);
+    for (size_t i = 0; i < robotCount; ++i) {
+        const RobotConfig& robot = config.robots[i];
+        robotIds[i] = robot.id;
+        kinds[i] = robot.kind;
+        x[i] = robot.x;
+        y[i] = robot.y;
+        headings[i] = robot.orientation;
+        speeds[i] = robot.speed;
+        sensorRanges[i] = robot.sensorRange;
+    }
+    RobotColumns robotColumns {robotCount, robotIds.data(), kinds.data(), x.data(), y.data(), headings.data(), speeds.data(), sensorRanges.data()};
+
+    size_t obstacleCount = config.obstacles.size();
+    std::vector<int32_t> obstacleIds(obstacleCount);
+    std::vector<double> obstacleX(obstacleCount), obstacleY(obstacleCount), obstacleSizes(obstacleCount);
+    for (size_t i = 0; i < obstacleCount; ++i) {
+        const ObstacleConfig& obstacle = config.obstacles[i];
+        obstacleIds[i] = obstacle.id;
+        obstacleX[i] = obstacle.x;
+        obstacleY[i] = obstacle.y;
+        obstacleSizes[i] = obstacle.size;
+    }
+    ObstacleColumns obstacleColumns {obstacleCount, obstacleIds.data(), obstacleX.data(), obstacleY.data(), obstacleSizes.data()};
+    return writeColumns(path, config.width, config.height, robotColumns, obstacleColumns, error);
+}
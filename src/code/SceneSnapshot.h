@@ -0,0 +1,154 @@
+/**
+ * @file SceneSnapshot.h
+ * @brief Versioned binary scene format that is memory-mapped instead of parsed.
+ *
+ * The text configuration format costs a tokenizer pass and a number conversion per field, which dominates loading
+ * scenes of a million entities. A snapshot stores the same scene as fixed-layout columns, one per field, in the
+ * order and representation RobotStore uses, so loading maps the file and copies each column into the store in one
+ * block.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef SCENESNAPSHOT_H
+#define SCENESNAPSHOT_H
+
+#include "cstddef"
+#include "cstdint"
+#include "string"
+#include "RobotStore.h"
+#include "MappedFile.h"
+#include "ConfigParser.h"
+
+class Environment;
+
+/**
+ * @brief First 64 bytes of a snapshot file.
+ *
+ * The columns follow the header back to back, each starting at a multiple of 8 bytes: robot identifiers (int32),
+ * kinds (uint8), x, y, headings, speeds and sensor ranges (double), then obstacle identifiers (int32), x, y and
+ * sizes (double). Values are stored in the byte order of the machine that wrote the file, which byteOrder records.
+ */
+struct SceneSnapshotHeader {
+    char magic[8]; ///< "RSIMSCN" followed by a zero byte.
+    uint32_t version; ///< Format version; files of other versions are rejected.
+    uint32_t byteOrder; ///< 0x01020304 as written by the producing machine.
+    uint64_t robotCount; ///< Number of robots.
+    uint64_t obstacleCount; ///< Number of obstacles.
+    double width; ///< Width of the environment.
+    double height; ///< Height of the environment.
+    uint64_t reserved[2]; ///< Zero; room for later versions.
+};
+
+static_assert(sizeof(SceneSnapshotHeader) == 64, "the snapshot header layout is part of the file format");
+static_assert(sizeof(RobotKind) == 1, "robot kinds are stored as single bytes");
+
+/**
+ * @class SceneSnapshot
+ * @brief Read-only memory mapping of a snapshot file, with typed access to its columns.
+ *
+ * The mapping lives as long as the object; the column pointers point straight into it.
+ */
+class SceneSnapshot {
+public:
+    static constexpr uint32_t currentVersion = 1; ///< Version written by write().
+
+    /**
+     * @brief Maps a snapshot file and checks that its header and size are consistent.
+     * @param path Path of the file.
+     * @param error Receives the reason if the file cannot be used.
+     * @return True if the columns may be read.
+     */
+    bool open(const std::string& path, std::string& error);
+
+    /**
+     * @brief Checks whether a file starts with the snapshot magic, without mapping it.
+     * @param path Path of the file.
+     * @return True for a snapshot file of any version.
+     */
+    static bool isSnapshot(const std::string& path);
+
+    /**
+     * @brief Writes the robots and obstacles of an environment as a snapshot file.
+     * @param path Path of the file to create or overwrite.
+     * @param environment Environment to write.
+     * @param error Receives the reason if the file cannot be written.
+     * @return True on success.
+     */
+    static bool write(const std::string& path, Environment& environment, std::string& error);
+
+    /**
+     * @brief Writes a parsed or generated configuration as a snapshot file, without building an environment.
+     * @param path Path of the file to create or overwrite.
+     * @param config Configuration to write; its width and height must be set.
+     * @param error Receives the reason if the file cannot be written.
+     * @return True on success.
+     */
+    static bool write(const std::string& path, const SceneConfig& config, std::string& error);
+
+    [[nodiscard]] const SceneSnapshotHeader& header() const { return *reinterpret_cast<const SceneSnapshotHeader*>(file.data()); } /// Header of the mapped file.
+    [[nodiscard]] size_t robotCount() const { return static_cast<size_t>(header().robotCount); } /// Number of robots.
+    [[nodiscard]] size_t obstacleCount() const { return static_cast<size_t>(header().obstacleCount); } /// Number of obstacles.
+
+    [[nodiscard]] const int32_t* robotIds() const { return column<int32_t>(Column::RobotIds); } /// Robot identifiers.
+    [[nodiscard]] const RobotKind* robotKinds() const { return column<RobotKind>(Column::RobotKinds); } /// Robot kinds.
+    [[nodiscard]] const double* robotX() const { return column<double>(Column::RobotX); } /// Robot x-coordinates.
+    [[nodiscard]] const double* robotY() const { return column<double>(Column::RobotY); } /// Robot y-coordinates.
+    [[nodiscard]] const double* robotHeadings() const { return column<double>(Column::RobotHeadings); } /// Robot orientations in degrees.
+    [[nodiscard]] const double* robotSpeeds() const { return column<double>(Column::RobotSpeeds); } /// Robot speeds.
+    [[nodiscard]] const double* robotSensorRanges() const { return column<double>(Column::RobotSensorRanges); } /// Robot sensor ranges.
+    [[nodiscard]] const int32_t* obstacleIds() const { return column<int32_t>(Column::ObstacleIds); } /// Obstacle identifiers.
+    [[nodiscard]] const double* obstacleX() const { return column<double>(Column::ObstacleX); } /// Obstacle x-coordinates.
+    [[nodiscard]] const double* obstacleY() const { return column<double>(Column::ObstacleY); } /// Obstacle y-coordinates.
+    [[nodiscard]] const double* obstacleSizes() const { return column<double>(Column::ObstacleSizes); } /// Obstacle sizes.
+
+private:
+    /**
+     * @brief The columns of a snapshot, in file order.
+     */
+    enum Column {
+        RobotIds, RobotKinds, RobotX, RobotY, RobotHeadings, RobotSpeeds, RobotSensorRanges,
+        ObstacleIds, ObstacleX, ObstacleY, ObstacleSizes,
+        ColumnCount ///< Number of columns; also the index of the end of the file in an offset table.
+    };
+
+    /**
+     * @brief Robot columns to be written, in file order.
+     */
+    struct RobotColumns {
+        size_t count; ///< Number of robots.
+        const int32_t* ids; ///< Identifiers.
+        const RobotKind* kinds; ///< Kinds.
+        const double* x; ///< x-coordinates.
+        const double* y; ///< y-coordinates.
+        const double* headings; ///< Orientations in degrees.
+        const double* speeds; ///< Speeds.
+        const double* sensorRanges; ///< Sensor ranges.
+    };
+
+    /**
+     * @brief Obstacle columns to be written, in file order.
+     */
+    struct ObstacleColumns {
+        size_t count; ///< Number of obstacles.
+        const int32_t* ids; ///< Identifiers.
+        const double* x; ///< x-coordinates.
+        const double* y; ///< y-coordinates.
+        const double* sizes; ///< Sizes.
+    };
+
+    static bool writeColumns(const std::string& path, double width, double height, const RobotColumns& robots,
+                             const ObstacleColumns& obstacles, std::string& error); ///< Write a header and its columns.
+    static void layout(uint64_t robots, uint64_t obstacles, uint64_t offsets[ColumnCount + 1]); ///< Compute column offsets.
+
+    template <typename T>
+    [[nodiscard]] const T* column(Column which) const {
+        return reinterpret_cast<const T*>(file.data() + offsets[which]);
+    }
+
+    MappedFile file; ///< The mapped snapshot file.
+    uint64_t offsets[ColumnCount + 1] = {}; ///< Byte offset of each column, and of the end of the file.
+};
+
+#endif // SCENESNAPSHOT_H
@@ -8,6 +8,7 @@
  */
 #include "SimulationEngine.h"
 #include "Obstacle.h"
+#include "Logger.h"
 
 /**
  * @brief Constructs a new SimulationEngine object with the specified parent.
@@ -18,6 +19,7 @@ SimulationEngine::SimulationEngine(Environment* environment, QObject* parent)
     : QObject(parent), environment(environment), timer(nullptr), running(false), timeStep(0.016) {
     startTime = std::chrono::steady_clock::now();
     lastUpdate = std::chrono::steady_clock::now();
+    publishSnapshot();
 }
 
 SimulationEngine::~SimulationEngine() {
@@ -29,65 +31,299 @@ SimulationEngine::~SimulationEngine() {
  * @brief Starts the simulation engine.
  */
 void SimulationEngine::start() {
-    if (running) return;  
-    running = true;
-    if (!timer) {
-        timer = new QTimer(this);  
-        connect(timer, &QTimer::timeout, this, &SimulationEngine::update);
-    }
-    timer->start(static_cast<int>(timeStep * 1000));  
+    post([this] {
+        if (running) return;
+        running = true;
+        {
+            std::lock_guard<std::mutex> lock(environment->getMutex());
+            environment->rebuildObstacleTree();
+        }
+        if (!timer) {
+            Profiler::setThreadName("simulation");
+            timer = new QTimer(this);  /// Created here rather than in the constructor so it belongs to the engine's thread.
+            timer->setTimerType(Qt::PreciseTimer);
+            connect(timer, &QTimer::timeout, this, &SimulationEngine::update);
+        }
+        lastUpdate = std::chrono::steady_clock::now();
+        accumulator = 0.0;
+        timer->start(static_cast<int>(timeStep * 1000));
+    });
 }
 
 /**
  * @brief Pauses the simulation engine.
  */
 void SimulationEngine::pause() {
-    running = false;
+    post([this] { running = false; });
 }
 
 /**
  * @brief Resumes the simulation engine.
  */
 void SimulationEngine::resume() {
-    running = true;
-    lastUpdate = std::chrono::steady_clock::now();
+    post([this] {
+        running = true;
+        lastUpdate = std::chrono::steady_clock::now();
+        accumulator = 0.0;
+    });
 }
 
 /**
  * @brief Stops the simulation engine.
  */
 void SimulationEngine::stop() {
-    running = false;
-    if (timer) {
-        timer->stop();  
+    post([this] {
+        running = false;
+        if (timer) {
+            timer->stop();
+        }
+    });
+}
+
+/**
+ * @brief Sets how fast simulated time passes relative to wall-clock time.
+ * @param scale 1 for real time, 10 for ten times faster, or AsFastAsPossible.
+ */
+void SimulationEngine::setTimeScale(double scale) {
+    post([this, scale] {
+        timeScale = scale > 0.0 ? scale : 1.0;
+        accumulator = 0.0;
+    });
+}
+
+/**
+ * @brief Sets the most ticks a single frame may run while catching up.
+ * @param steps Upper bound on ticks per frame; simulated time beyond it is dropped.
+ */
+void SimulationEngine::setMaxStepsPerFrame(int steps) {
+    post([this, steps] { maxStepsPerFrame = std::max(1, steps); });
+}
+
+/**
+ * @brief Publishes a fresh snapshot after the environment was edited from outside the engine, for example reloaded.
+ */
+void SimulationEngine::refresh() {
+    post([this] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        ++obstacleRevision;
+        publishSnapshot();
+    });
+}
+
+/**
+ * @brief Gets the newest snapshot published by the engine. Call it from the GUI thread only.
+ * @return The snapshot; it stays valid and unchanged until the next call.
+ */
+const RenderSnapshot& SimulationEngine::latestSnapshot() {
+    /// Clear the flag before taking the buffer: a snapshot published in between then notifies again instead of being missed.
+    snapshotPending.store(false, std::memory_order_release);
+    snapshots.update();
+    return snapshots.front();
+}
+
+/**
+ * @brief Runs a task on the thread the engine lives on.
+ * @param task Task to run; it runs at once if the caller already is on that thread, and is queued otherwise.
+ */
+void SimulationEngine::post(std::function<void()> task) {
+    if (QThread::currentThread() == thread()) {
+        task();
+    } else {
+        QMetaObject::invokeMethod(this, std::move(task), Qt::QueuedConnection);
+    }
+}
+
+/**
+ * @brief Copies the environment into the writer's snapshot, publishes it and notifies the GUI.
+ *
+ * Must run on the engine's thread with the environment's mutex held or no other thread editing. Snapshot buffers
+ * are recycled, so their vectors stop allocating once they have grown to the size of the scene, and the obstacle
+ * list is copied only into buffers whose revision is out of date.
+ */
+void SimulationEngine::publishSnapshot() {
+    PROFILE_SCOPE(ProfilePhase::GuiEmit);
+    RenderSnapshot& snapshot = snapshots.back();
+    const RobotStore& store = environment->getRobotStore();
+    snapshot.tick = tickCount;
+    snapshot.robots.resize(store.size());
+    for (size_t slot = 0; slot < store.size(); ++slot) {
+        snapshot.robots[slot] = RobotPose{store.ids[slot], environment->robotHandleAt(slot), store.kinds[slot],
+                                          store.x[slot], store.y[slot], store.headings[slot], store.speeds[slot],
+                                          store.sensorRanges[slot]};
+    }
+    if (snapshot.obstacleRevision != obstacleRevision) {
+        snapshot.obstacles.clear();
+        const auto& obstacles = environment->getObstacles();
+        for (size_t index = 0; index < obstacles.size(); ++index) {
+            snapshot.obstacles.push_back(ObstaclePose{obstacles[index]->getId(), environment->obstacleHandleAt(index),
+                                                      obstacles[index]->getBounds()});
+        }
+        snapshot.obstacleRevision = obstacleRevision;
+    }
+    snapshots.publish();
+    if (!snapshotPending.exchange(true, std::memory_order_acq_rel)) {
+        emit updateGUI();
     }
 }
 
 /**
  * @brief Updates the simulation engine.
+ *
+ * Called once per timer frame. Wall-clock time since the last frame, multiplied by the time scale, is added to an
+ * accumulator and paid out in whole ticks of timeStep simulated seconds, so every tick is identical no matter how
+ * often or how late the timer fires. When the simulation falls behind, at most maxStepsPerFrame ticks are run and
+ * the rest of the backlog is dropped rather than letting it grow. At AsFastAsPossible, ticks run back to back for
+ * half a frame, leaving the other half to the event loop. A snapshot is published once per frame, not once per tick.
  */
 void SimulationEngine::update() {
     if (!running) return;
+    std::lock_guard<std::mutex> lock(environment->getMutex());
 
-    double maxWidth = environment->width;
-    double maxHeight = environment->height;
     auto now = std::chrono::steady_clock::now();
-    double elapsedMilliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(now - lastUpdate).count();
+    double elapsedSeconds = std::chrono::duration<double>(now - lastUpdate).count();
+    lastUpdate = now;
 
-    if (elapsedMilliseconds < timeStep * 1000) {
-        return; 
+    int steps = 0;
+    if (std::isinf(timeScale)) {
+        auto deadline = now + std::chrono::microseconds(static_cast<long long>(timeStep * 500000));
+        do {
+            step();
+            ++steps;
+        } while (std::chrono::steady_clock::now() < deadline);
+    } else {
+        accumulator += elapsedSeconds * timeScale;
+        while (accumulator >= timeStep && steps < maxStepsPerFrame) {
+            step();
+            accumulator -= timeStep;
+            ++steps;
+        }
+        if (accumulator >= timeStep) {
+            accumulator = std::fmod(accumulator, timeStep);
+        }
     }
 
-    for (auto& robot : environment->getRobots()) {
-        robot->move(maxWidth, maxHeight);
-        RemoteControlledRobot* rcr = dynamic_cast<RemoteControlledRobot*>(robot.get());
-        if (rcr) {
-            rcr->update();
+    if (steps > 0) {
+        publishSnapshot();
+    }
+}
+
+/**
+ * @brief Advances the simulation by exactly one tick.
+ *
+ * Unlike update(), this does not look at the wall clock or the running flag, take the environment's mutex or publish a snapshot, so it can be driven in a tight loop by the headless runner.
+ * The tick and its phases are timed by the profiler while it is switched on.
+ */
+void SimulationEngine::step() {
+    PROFILE_SCOPE(ProfilePhase::Tick);
+    {
+        PROFILE_SCOPE(ProfilePhase::RemoteInput);
+        drainCommands();  /// Before the spatial index is rebuilt, so speed changes are already accounted for.
+    }
+    double maxWidth = environment->width;
+    double maxHeight = environment->height;
+    {
+        PROFILE_SCOPE(ProfilePhase::SpatialIndex);
+        environment->updateSpatialIndex();
+        environment->getObstacleTree();  /// Rebuild a stale tree now, before worker threads share it.
+    }
+
+    /// Walk the component store: handles and type tags are contiguous, and both robot classes are final, so each
+    /// call below is resolved statically, with no RTTI and no virtual dispatch.
+    RobotStore& robots = environment->getRobotStore();
+    if (updateMode == UpdateMode::Sequential) {
+        /// Robots see each other's live positions here, so they keep moving in slot order rather than kind by kind.
+        /// Sensing and moving interleave robot by robot, so both are timed as Movement.
+        PROFILE_SCOPE(ProfilePhase::Movement);
+        for (size_t slot = 0; slot < robots.size(); ++slot) {
+            if (robots.kinds[slot] == RobotKind::Autonomous) {
+                static_cast<AutonomousRobot*>(robots.handles[slot])->move(maxWidth, maxHeight);
+            } else {
+                auto* robot = static_cast<RemoteControlledRobot*>(robots.handles[slot]);
+                robot->move(maxWidth, maxHeight);
+                robot->update();
+            }
         }
+        ++tickCount;
+        return;
     }
 
-    emit updateGUI();
-    lastUpdate = now;
+    /// Robots only write their own slot and read everyone else from the snapshot, so any chunk may run on any
+    /// thread in any order. Sensing only turns robots, so it can finish for all of them before the first one moves.
+    /// Each phase walks the slot list of one kind, so the loops neither test tags nor skip robots of the other kind.
+    const std::vector<uint32_t>& autonomous = robots.autonomousSlots;
+    const std::vector<uint32_t>& remote = robots.remoteSlots;
+    robots.takeSnapshot();
+    {
+        PROFILE_SCOPE(ProfilePhase::Sensing);
+        runPhase(autonomous.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                static_cast<AutonomousRobot*>(robots.handles[autonomous[i]])->sense(maxWidth, maxHeight);
+            }
+        });
+    }
+    {
+        PROFILE_SCOPE(ProfilePhase::Movement);
+        runPhase(autonomous.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                static_cast<AutonomousRobot*>(robots.handles[autonomous[i]])->advance(maxWidth, maxHeight);
+            }
+        });
+        runPhase(remote.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                static_cast<RemoteControlledRobot*>(robots.handles[remote[i]])->move(maxWidth, maxHeight);
+            }
+        });
+        runPhase(remote.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i) {
+                static_cast<RemoteControlledRobot*>(robots.handles[remote[i]])->update();
+            }
+        });
+    }
+    robots.releaseSnapshot();
+    ++tickCount;
+}
+
+/**
+ * @brief Runs one phase of a Parallel tick over all robot slots.
+ * @param count Number of robot slots.
+ * @param body Callable taking the begin and end of a range of slots.
+ */
+void SimulationEngine::runPhase(size_t count, const std::function<void(size_t, size_t)>& body) {
+    if (scheduler) {
+        scheduler->parallelFor(count, chunkSize, body);
+    } else {
+        body(0, count);
+    }
+}
+
+/**
+ * @brief Selects how robots are updated within a tick.
+ * @param mode Sequential or Parallel.
+ * @param threads Worker threads for Parallel mode, including the calling thread; 0 uses every hardware thread.
+ */
+void SimulationEngine::setUpdateMode(UpdateMode mode, int threads) {
+    if (threads <= 0) {
+        threads = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+    }
+    /// Queued like every other control function, so the scheduler is never replaced in the middle of a tick.
+    post([this, mode, threads] {
+        updateMode = mode;
+        if (mode == UpdateMode::Parallel && threads > 1) {
+            if (!scheduler || scheduler->getThreadCount() != threads) {
+                scheduler = std::make_unique<TaskScheduler>(threads);
+            }
+        } else {
+            scheduler.reset();
+        }
+    });
+}
+
+/**
+ * @brief Sets how many robots a scheduler chunk holds in Parallel mode.
+ * @param robots Robots per chunk; smaller chunks balance better, larger ones cost less to hand out.
+ */
+void SimulationEngine::setChunkSize(int robots) {
+    post([this, robots] { chunkSize = static_cast<size_t>(std::max(1, robots)); });
 }
 
 /**
@@ -122,17 +358,25 @@ std::vector<Obstacle*> SimulationEngine::getObstacles() const {
  * @param speed The speed of the robot to add.
  * @param orientation The orientation of the robot to add.
  * @param sensorSize The sensor size of the robot to add.
+ *
+ * Nothing is added if a robot with the same ID already exists.
  */
 void SimulationEngine::addRobot(const QString& type, int id, const QPointF& position, double speed, double orientation, double sensorSize) {
-    std::unique_ptr<Robot> robot;
-    double maxWidth = 800;
-    double maxHeight = 600;
-    if (type == "autonomous") {
-        robot = std::make_unique<AutonomousRobot>(id, std::make_pair(position.x(), position.y()), speed, orientation, sensorSize, maxWidth, maxHeight, environment);
-    } else {
-        robot = std::make_unique<RemoteControlledRobot>(id, std::make_pair(position.x(), position.y()), speed, orientation, sensorSize, environment);
-    }
-    environment->addRobot(std::move(robot));
+    post([this, type, id, position, speed, orientation, sensorSize] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        std::unique_ptr<Robot> robot;
+        double maxWidth = 800;
+        double maxHeight = 600;
+        if (type == "autonomous") {
+            robot = std::make_unique<AutonomousRobot>(id, std::make_pair(position.x(), position.y()), speed, orientation, sensorSize, maxWidth, maxHeight, environment);
+        } else {
+            robot = std::make_unique<RemoteControlledRobot>(id, std::make_pair(position.x(), position.y()), speed, orientation, sensorSize, environment);
+        }
+        if (!environment->addRobot(std::move(robot))) {
+            LOG_WARNING("A robot with ID: " << id << " already exists, add failed.");
+        }
+        publishSnapshot();
+    });
 }
 
 /**
@@ -140,32 +384,47 @@ void SimulationEngine::addRobot(const QString& type, int id, const QPointF& posi
  * @param id The ID of the obstacle to add.
  * @param position The position of the obstacle to add.
  * @param size The size of the obstacle to add.
+ *
+ * Nothing is added if an obstacle with the same ID already exists.
  */
 void SimulationEngine::addObstacle(int id, const QPointF& position, double size) {
-    auto obstacle = std::make_unique<Obstacle>(id, std::make_pair(position.x(), position.y()), size);
-    environment->addObstacle(std::move(obstacle));
+    post([this, id, position, size] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        auto obstacle = std::make_unique<Obstacle>(id, std::make_pair(position.x(), position.y()), size);
+        if (!environment->addObstacle(std::move(obstacle))) {
+            LOG_WARNING("An obstacle with ID: " << id << " already exists, add failed.");
+        }
+        environment->rebuildObstacleTree();
+        ++obstacleRevision;
+        publishSnapshot();
+    });
 }
 
 /**
- * @brief Updates the robot with the specified ID.
- * @param id The ID of the robot to update.
+ * @brief Updates a robot.
+ * @param handle The handle of the robot to update; nothing happens if the robot has been removed meanwhile.
  * @param speed The speed of the robot.
  * @param orientation The orientation of the robot.
  * @param sensorSize The sensor size of the robot.
  * @param x The x-coordinate of the robot.
  * @param y The y-coordinate of the robot.
  */
-void SimulationEngine::updateRobot(int id, double speed, double orientation, double sensorSize, double x, double y) {
-    Robot* robot = getRobotById(id);
-    if (robot) {
-        robot->setSpeed(speed);
-        robot->setOrientation(orientation);
-        robot->setSensorSize(sensorSize);
-        robot->setPosition(std::make_pair(x, y));
-        qDebug() << "Updating robot with ID:" << id << " to speed:" << speed << ", orientation:" << orientation << ", sensorSize:" << sensorSize;
-    } else {
-        qDebug() << "No robot found with ID:" << id << ", update failed.";
-    }
+void SimulationEngine::updateRobot(SlotHandle handle, double speed, double orientation, double sensorSize, double x, double y) {
+    post([this, handle, speed, orientation, sensorSize, x, y] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        Robot* robot = environment->getRobot(handle);
+        if (robot) {
+            int id = robot->getID();
+            robot->setSpeed(speed);
+            robot->setOrientation(orientation);
+            robot->setSensorSize(sensorSize);
+            robot->setPosition(std::make_pair(x, y));
+            LOG_DEBUG("Updating robot with ID: " << id << " to speed: " << speed << ", orientation: " << orientation << ", sensorSize: " << sensorSize);
+        } else {
+            LOG_WARNING("The robot no longer exists, update failed.");
+        }
+        publishSnapshot();
+    });
 }
 
 /**
@@ -174,10 +433,7 @@ void SimulationEngine::updateRobot(int id, double speed, double orientation, dou
  * @return A pointer to the robot with the specified ID, or nullptr if no such robot exists.
  */
 Robot* SimulationEngine::findRobotById(int id) {
-    auto& robots = environment->getRobots();
-    auto it = std::find_if(robots.begin(), robots.end(),
-                           [id](const std::unique_ptr<Robot>& robot) { return robot->getID() == id; });
-    return it != robots.end() ? it->get() : nullptr;
+    return environment->findRobot(id);
 }
 
 Robot* SimulationEngine::getRobotById(int id) {
@@ -185,21 +441,27 @@ Robot* SimulationEngine::getRobotById(int id) {
 }
 
 /**
- * @brief Updates the obstacle with the specified ID.
- * @param id The ID of the obstacle to update.
+ * @brief Updates an obstacle.
+ * @param handle The handle of the obstacle to update; nothing happens if the obstacle has been removed meanwhile.
  * @param size The size of the obstacle.
  * @param x The x-coordinate of the obstacle.
  * @param y The y-coordinate of the obstacle.
  */
-void SimulationEngine::updateObstacle(int id, double size, double x, double y) {
-    Obstacle* obstacle = getObstacleById(id);
-    if (obstacle) {
-        qDebug() << "Updating obstacle with ID:" << id << " to size:" << size;
-        obstacle->setSize(size);
-        obstacle->setPosition(std::make_pair(x, y));
-    } else {
-        qDebug() << "No obstacle found with ID:" << id << ", update failed.";
-    }
+void SimulationEngine::updateObstacle(SlotHandle handle, double size, double x, double y) {
+    post([this, handle, size, x, y] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        Obstacle* obstacle = environment->getObstacle(handle);
+        if (obstacle) {
+            LOG_DEBUG("Updating obstacle with ID: " << obstacle->getId() << " to size: " << size);
+            obstacle->setSize(size);
+            obstacle->setPosition(std::make_pair(x, y));
+            environment->rebuildObstacleTree();
+        } else {
+            LOG_WARNING("The obstacle no longer exists, update failed.");
+        }
+        ++obstacleRevision;
+        publishSnapshot();
+    });
 }
 
 /**
@@ -217,9 +479,7 @@ Obstacle* SimulationEngine::getObstacleById(int id) {
  * @return A pointer to the obstacle with the specified ID, or nullptr if no such obstacle exists.
  */
 Obstacle* SimulationEngine::findObstacleById(int id) {
-    auto it = std::find_if(environment->getObstacles().begin(), environment->getObstacles().end(),
-                           [id](const std::unique_ptr<Obstacle>& obstacle) { return obstacle->getId() == id; });
-    return it != environment->getObstacles().end() ? it->get() : nullptr;
+    return environment->findObstacle(id);
 }
 
 /**
@@ -227,18 +487,15 @@ Obstacle* SimulationEngine::findObstacleById(int id) {
  * @param id The ID of the robot to remove.
  */
 void SimulationEngine::removeRobot(int id) {
-    std::cout << "Available Robot IDs: ";
-    for (const auto& robot : environment->getRobots()) {
-        std::cout << robot->getID() << " ";
-    }
-    std::cout << std::endl;
-
-    std::cout << "Attempting to remove robot with ID: " << id << std::endl;
-    if (environment->removeRobot(id)) {
-        std::cout << "Robot removed." << std::endl;
-    } else {
-        std::cout << "Robot not found." << std::endl;
-    }
+    post([this, id] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        if (environment->removeRobot(id)) {
+            LOG_DEBUG("Robot with ID: " << id << " removed.");
+        } else {
+            LOG_WARNING("Robot with ID: " << id << " not found, remove failed.");
+        }
+        publishSnapshot();
+    });
 }
 
 /**
@@ -246,23 +503,90 @@ void SimulationEngine::removeRobot(int id) {
  * @param id The ID of the obstacle to remove.
  */
 void SimulationEngine::removeObstacle(int id) {
-    if (environment->removeObstacle(id)) {
-        std::cout << "Obstacle removed." << std::endl;
-    } else {
-        std::cout << "Obstacle not found." << std::endl;
-    }
+    post([this, id] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        if (environment->removeObstacle(id)) {
+            environment->rebuildObstacleTree();
+            LOG_DEBUG("Obstacle with ID: " << id << " removed.");
+        } else {
+            LOG_WARNING("Obstacle with ID: " << id << " not found, remove failed.");
+        }
+        ++obstacleRevision;
+        publishSnapshot();
+    });
 }
 
 /**
- * @brief Sends a command to the remote-controlled robots.
+ * @brief Removes a robot by handle.
+ * @param handle The handle of the robot to remove; nothing happens if the robot has been removed meanwhile.
+ */
+void SimulationEngine::removeRobot(SlotHandle handle) {
+    post([this, handle] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        if (environment->removeRobot(handle)) {
+            LOG_DEBUG("Robot removed.");
+        } else {
+            LOG_WARNING("The robot no longer exists, remove failed.");
+        }
+        publishSnapshot();
+    });
+}
+
+/**
+ * @brief Removes an obstacle by handle.
+ * @param handle The handle of the obstacle to remove; nothing happens if the obstacle has been removed meanwhile.
+ */
+void SimulationEngine::removeObstacle(SlotHandle handle) {
+    post([this, handle] {
+        std::lock_guard<std::mutex> lock(environment->getMutex());
+        if (environment->removeObstacle(handle)) {
+            environment->rebuildObstacleTree();
+            LOG_DEBUG("Obstacle removed.");
+        } else {
+            LOG_WARNING("The obstacle no longer exists, remove failed.");
+        }
+        ++obstacleRevision;
+        publishSnapshot();
+    });
+}
+
+/**
+ * @brief Queues a command for remote-controlled robots; it is executed at the start of the next tick.
  * @param command The command to send.
+ * @return False if the queue is full and the command was dropped.
+ *
+ * Safe from any thread. Unlike the editing functions, it takes no lock and posts nothing, so scripts can drive
+ * hundreds of robots individually without waiting for the simulation. Commands sent while the simulation is
+ * paused take effect when it resumes.
  */
-void SimulationEngine::sendCommand(const QString &command) {
-    auto remoteRobots = environment->findRemoteControlledRobots();
+bool SimulationEngine::sendCommand(const RobotCommand &command) {
+    if (!commands.push(command)) {
+        LOG_WARNING("Command queue full, command dropped.");
+        return false;
+    }
+    return true;
+}
 
-    for (auto& rcr : remoteRobots) {
-        if (rcr) {
-            rcr->processCommand(command);
+/**
+ * @brief Executes every command queued so far, in the order they were queued.
+ *
+ * Runs on the simulation thread at the start of a tick. A command for a single robot is a hash lookup; a command
+ * for a group or for all robots walks the cached list of remote-controlled robots.
+ */
+void SimulationEngine::drainCommands() {
+    RobotCommand command;
+    for (size_t taken = 0; taken < commands.capacity() && commands.pop(command); ++taken) {
+        if (command.target == CommandTarget::Robot) {
+            Robot* robot = environment->findRobot(command.targetId);
+            if (robot && robot->getKind() == RobotKind::Remote) {
+                static_cast<RemoteControlledRobot*>(robot)->execute(command);
+            }
+            continue;
+        }
+        for (RemoteControlledRobot* rcr : environment->findRemoteControlledRobots()) {
+            if (command.target == CommandTarget::All || rcr->getGroup() == command.targetId) {
+                rcr->execute(command);
+            }
         }
     }
 }
@@ -14,26 +14,51 @@
 #include "QObject"
 #include "QList"
 #include "QTimer"
+#include "QThread"
 #include "vector"
 #include "memory"
 #include "algorithm"
 #include "chrono"
 #include "thread"
 #include "cmath"
+#include "limits"
 #include "ostream"
 #include "iostream"
+#include "atomic"
+#include "mutex"
+#include "functional"
 
 #include "Environment.h"
 #include "Robot.h"
 #include "Obstacle.h"
 #include "AutonomousRobot.h"
 #include "RemoteControlledRobot.h"
+#include "TaskScheduler.h"
+#include "TripleBuffer.h"
+#include "RenderSnapshot.h"
+#include "RobotCommand.h"
+#include "MpscQueue.h"
+#include "Profiler.h"
+
+/**
+ * @brief How the robots of one tick are updated.
+ */
+enum class UpdateMode {
+    Sequential, ///< One robot after another on the calling thread; later robots see moves made earlier in the tick.
+    Parallel ///< On the task scheduler; every robot sees the others where they were at the start of the tick.
+};
 
 /**
  * @class SimulationEngine
  * @brief Manages the interactions and state of a simulated robotic environment.
  *
  * The SimulationEngine is responsible for updating the state of the environment and its entities. It controls the flow of the simulation and provides interfaces to interact with the environment.
+ *
+ * The engine may live on a thread of its own. The control and editing functions may be called from any thread; when
+ * called from another one, they are queued to the engine's thread and return at once. The GUI never reads the
+ * environment: after each frame and each edit the engine publishes a RenderSnapshot through a triple buffer, emits
+ * updateGUI, and the GUI draws latestSnapshot(). Ticks and edits hold the environment's mutex, so code outside the
+ * engine may edit the environment directly as long as it holds that mutex too and calls refresh() afterwards.
  */
 
 class SimulationEngine : public QObject {
@@ -61,24 +86,87 @@ public:
     void resume();
     void stop();
     void update();
+    void step();
+    void refresh();
+
+    /**
+ * @brief Gets the newest snapshot published by the engine. Call it from the GUI thread only.
+ * @return The snapshot; it stays valid and unchanged until the next call.
+ */
+    const RenderSnapshot& latestSnapshot();
+
+    /// Time scale that runs as many ticks as fit into each frame instead of following the wall clock.
+    static constexpr double AsFastAsPossible = std::numeric_limits<double>::infinity();
+
+    /**
+ * @brief Sets how fast simulated time passes relative to wall-clock time.
+ * @param scale 1 for real time, 10 for ten times faster, or AsFastAsPossible.
+ */
+    void setTimeScale(double scale);
+    /**
+ * @brief Gets how fast simulated time passes relative to wall-clock time.
+ * @return The current time scale.
+ */
+    [[nodiscard]] double getTimeScale() const { return timeScale; }
+    /**
+ * @brief Sets the most ticks a single frame may run while catching up.
+ * @param steps Upper bound on ticks per frame; simulated time beyond it is dropped.
+ */
+    void setMaxStepsPerFrame(int steps);
+    /**
+ * @brief Selects how robots are updated within a tick.
+ * @param mode Sequential or Parallel.
+ * @param threads Worker threads for Parallel mode, including the calling thread; 0 uses every hardware thread.
+ *
+ * Parallel results depend only on the previous tick, so they are the same for every thread count.
+ */
+    void setUpdateMode(UpdateMode mode, int threads = 0);
+    /**
+ * @brief Gets how robots are updated within a tick. Call it from the engine's thread only.
+ * @return The update mode.
+ */
+    [[nodiscard]] UpdateMode getUpdateMode() const { return updateMode; }
+    /**
+ * @brief Sets how many robots a scheduler chunk holds in Parallel mode.
+ * @param robots Robots per chunk; smaller chunks balance better, larger ones cost less to hand out.
+ */
+    void setChunkSize(int robots);
+    /**
+ * @brief Gets the scheduler running Parallel ticks, for example to read its utilization statistics. Call it from the
+ * engine's thread only: setUpdateMode() may replace the scheduler.
+ * @return The scheduler, or nullptr unless Parallel mode uses more than one thread.
+ */
+    [[nodiscard]] TaskScheduler* getScheduler() const { return scheduler.get(); }
+    /**
+ * @brief Gets the number of ticks simulated so far.
+ * @return The tick count.
+ */
+    [[nodiscard]] long long getTickCount() const { return tickCount; }
+    /**
+ * @brief Gets the simulated time, which advances by exactly one time step per tick.
+ * @return Simulated time in seconds.
+ */
+    [[nodiscard]] double getSimulationTime() const { return tickCount * timeStep; }
     void removeRobot(int id);
     void removeObstacle(int id);
-    void sendCommand(const QString &command);
-    void updateObstacle(int id, double size, double x, double y);
+    void removeRobot(SlotHandle handle);
+    void removeObstacle(SlotHandle handle);
+    bool sendCommand(const RobotCommand &command);
+    void updateObstacle(SlotHandle handle, double size, double x, double y);
     void addObstacle(int id, const QPointF &position, double size);
-    void updateRobot(int id, double speed, double orientation, double sensorSize, double x, double y);
+    void updateRobot(SlotHandle handle, double speed, double orientation, double sensorSize, double x, double y);
     void addRobot(const QString &type, int id, const QPointF &position, double speed, double orientation, double sensorRange);
 
     Obstacle* getObstacleById(int id);
     Obstacle* findObstacleById(int id);
 
     /**
- * @brief Retrieves all robots in the simulation.
+ * @brief Retrieves all robots in the simulation. Only safe on the engine's thread; the GUI uses latestSnapshot().
  * @return A vector of pointers to Robot objects.
  */
     [[nodiscard]] std::vector<Robot*> getRobots() const;
     /**
- * @brief Retrieves all obstacles in the simulation.
+ * @brief Retrieves all obstacles in the simulation. Only safe on the engine's thread; the GUI uses latestSnapshot().
  * @return A vector of pointers to Obstacle objects.
  */
     [[nodiscard]] std::vector<Obstacle*> getObstacles() const;
@@ -89,6 +177,9 @@ public:
 signals:
     /**
  * @brief Signal to update the GUI to reflect changes in the simulation.
+ *
+ * Emitted when a new snapshot is published, but not again until the GUI has called latestSnapshot(), so a slow
+ * GUI never builds up a queue of stale notifications.
  */
     void updateGUI();
 
@@ -97,7 +188,24 @@ private:
     QTimer* timer; ///< Timer to manage simulation updates.
 
     bool running; ///< Flag to check if the simulation is currently running.
-    double timeStep; ///< Time step for simulation updates.
+    double timeStep; ///< Simulated seconds per tick, also the timer interval.
+    double timeScale = 1.0; ///< Simulated seconds per wall-clock second.
+    double accumulator = 0.0; ///< Simulated time owed to the simulation but not yet stepped.
+    int maxStepsPerFrame = 100; ///< Cap on catch-up ticks per frame.
+    long long tickCount = 0; ///< Ticks simulated so far.
+    UpdateMode updateMode = UpdateMode::Sequential; ///< How robots are updated within a tick.
+    std::unique_ptr<TaskScheduler> scheduler; ///< Workers for Parallel mode, or nullptr when running on one thread.
+    size_t chunkSize = 16; ///< Robots per scheduler chunk.
+
+    TripleBuffer<RenderSnapshot> snapshots; ///< Hands finished frames from the engine's thread to the GUI thread.
+    std::atomic<bool> snapshotPending{false}; ///< Set while an updateGUI is queued that the GUI has not acted on yet.
+    unsigned long obstacleRevision = 1; ///< Bumped on every obstacle edit, so snapshots copy obstacles only when they changed.
+    MpscQueue<RobotCommand> commands{16384}; ///< Commands sent from any thread, executed at the start of the next tick.
+
+    void runPhase(size_t count, const std::function<void(size_t, size_t)>& body); ///< Run one Parallel phase.
+    void post(std::function<void()> task); ///< Run a task on the engine's thread.
+    void publishSnapshot(); ///< Copy the environment into the next snapshot and notify the GUI.
+    void drainCommands(); ///< Execute every queued command.
 
     std::chrono::steady_clock::time_point startTime; ///< Start time of the simulation.
     std::chrono::steady_clock::time_point lastUpdate; ///< Time point of the last update.
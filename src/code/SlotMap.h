@@ -0,0 +1,170 @@
+/**
+ * @file SlotMap.h
+ * @brief Dense container addressed by generational handles that stay valid across insertions and removals.
+ *
+ * Robots and obstacles are spawned and removed while views, dialogs and queued commands still refer to them. A raw
+ * pointer or list position goes stale silently when that happens; a handle carries the generation of the slot it was
+ * issued for, so a handle to a removed entity is detected instead of reaching whatever took its place.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include "vector"
+#include "cstddef"
+#include "cstdint"
+#include "utility"
+
+/**
+ * @brief Stable reference to an element of a SlotMap.
+ */
+struct SlotHandle {
+    static constexpr uint32_t invalidIndex = 0xFFFFFFFFu; ///< Index of the null handle.
+
+    uint32_t index = invalidIndex; ///< Slot the element was inserted into.
+    uint32_t generation = 0; ///< Generation of the slot at insertion; bumped whenever the slot is freed.
+
+    [[nodiscard]] bool isNull() const { return index == invalidIndex; } /// True for a default-constructed handle.
+    bool operator==(const SlotHandle& other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const SlotHandle& other) const { return !(*this == other); }
+};
+
+/**
+ * @class SlotMap
+ * @brief Keeps elements contiguous and hands out generational handles to them.
+ *
+ * Elements live in a dense vector, so iterating them is a plain loop. A second vector of slots maps each handle to
+ * the element's current dense position. Removal moves the last element into the hole (swap-and-pop), bumps the
+ * generation of the freed slot and pushes the slot onto a free list, from which the next insertion takes it. Both
+ * vectors keep their capacity, so steady churn of inserts and removals does no container allocations.
+ *
+ * @tparam T Element type; must be movable.
+ */
+template <typename T>
+class SlotMap {
+public:
+    /**
+     * @brief Inserts an element at the end of the dense range.
+     * @param value Element to insert.
+     * @return Handle to the element, valid until it is removed.
+     */
+    SlotHandle insert(T value) {
+        uint32_t index;
+        if (freeHead != SlotHandle::invalidIndex) {
+            index = freeHead;
+            freeHead = entries[index].dense;
+        } else {
+            index = static_cast<uint32_t>(entries.size());
+            entries.push_back(Slot());
+        }
+        entries[index].dense = static_cast<uint32_t>(elements.size());
+        elements.push_back(std::move(value));
+        denseSlots.push_back(index);
+        return SlotHandle{index, entries[index].generation};
+    }
+
+    /**
+     * @brief Removes an element; the last element takes its dense position.
+     * @param handle Handle of the element.
+     * @return False if the handle is null or stale.
+     */
+    bool remove(SlotHandle handle) {
+        if (!contains(handle)) {
+            return false;
+        }
+        Slot& slot = entries[handle.index];
+        uint32_t hole = slot.dense;
+        uint32_t last = static_cast<uint32_t>(elements.size() - 1);
+        if (hole != last) {
+            elements[hole] = std::move(elements[last]);
+            denseSlots[hole] = denseSlots[last];
+            entries[denseSlots[hole]].dense = hole;
+        }
+        elements.pop_back();
+        denseSlots.pop_back();
+        ++slot.generation;
+        slot.dense = freeHead;
+        freeHead = handle.index;
+        return true;
+    }
+
+    /**
+     * @brief Removes all elements; every handle issued so far becomes stale.
+     */
+    void clear() {
+        for (uint32_t index : denseSlots) {
+            ++entries[index].generation;
+            entries[index].dense = freeHead;
+            freeHead = index;
+        }
+        elements.clear();
+        denseSlots.clear();
+    }
+
+    /**
+     * @brief Checks whether a handle refers to an element that is still in the map.
+     * @param handle Handle to check.
+     * @return True if the element has not been removed.
+     */
+    [[nodiscard]] bool contains(SlotHandle handle) const {
+        return handle.index < entries.size() && entries[handle.index].generation == handle.generation;
+    }
+
+    /**
+     * @brief Gets an element by handle.
+     * @param handle Handle of the element.
+     * @return Pointer to the element, or nullptr if the handle is null or stale. Valid until the next insert or remove.
+     */
+    T* get(SlotHandle handle) { return contains(handle) ? &elements[entries[handle.index].dense] : nullptr; }
+    const T* get(SlotHandle handle) const { return contains(handle) ? &elements[entries[handle.index].dense] : nullptr; } /// Const overload of get.
+
+    /**
+     * @brief Gets the dense position of an element.
+     * @param handle Handle of an element in the map.
+     * @return Position in values(); it changes when another element is removed.
+     */
+    [[nodiscard]] size_t denseIndex(SlotHandle handle) const { return entries[handle.index].dense; }
+
+    /**
+     * @brief Gets the handle of the element at a dense position.
+     * @param dense Position in values().
+     * @return Handle of that element.
+     */
+    [[nodiscard]] SlotHandle handleAt(size_t dense) const {
+        uint32_t index = denseSlots[dense];
+        return SlotHandle{index, entries[index].generation};
+    }
+
+    /**
+     * @brief Reserves room for a number of elements.
+     * @param count Total number of elements to make room for.
+     */
+    void reserve(size_t count) {
+        elements.reserve(count);
+        denseSlots.reserve(count);
+        entries.reserve(count);
+    }
+
+    std::vector<T>& values() { return elements; } /// Elements in dense order; do not insert or erase through this.
+    [[nodiscard]] const std::vector<T>& values() const { return elements; } /// Elements in dense order.
+    [[nodiscard]] size_t size() const { return elements.size(); } /// Number of elements.
+
+private:
+    /**
+     * @brief Indirection from a handle to a dense position.
+     */
+    struct Slot {
+        uint32_t dense = 0; ///< Dense position while the slot is in use, next free slot while it is free.
+        uint32_t generation = 0; ///< Bumped every time the slot is freed.
+    };
+
+    std::vector<T> elements; ///< The elements, contiguous.
+    std::vector<uint32_t> denseSlots; ///< Slot of each element, parallel to elements.
+    std::vector<Slot> entries; ///< All slots ever created, used or free; not named slots, which is a Qt keyword macro.
+    uint32_t freeHead = SlotHandle::invalidIndex; ///< First free slot, or invalidIndex if none.
+};
+
+#endif // SLOTMAP_H
@@ -0,0 +1,84 @@
+/**
+ * @file SpatialHash.cpp
+ * @brief Implements the uniform grid declared in SpatialHash.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "SpatialHash.h"
+#include "cmath"
+#include "cstdint"
+
+/**
+ * @brief Rebuilds the grid from the current robots.
+ * @param robots Store whose slots are inserted, bucketed by their current position.
+ * @param width Width of the covered area.
+ * @param height Height of the covered area.
+ * @param cellSize Smallest edge length of one cell; grown when the grid would exceed its cell budget.
+ * @param slack Largest distance a robot may move before the next rebuild.
+ *
+ * The grid may hold cellsPerRobot cells per robot, at least minCellBudget and at most INT32_MAX, so the offset table
+ * stays proportional to the robots and every cell index fits the 32-bit robotCells. Cells are grown until the grid
+ * fits; queries only become less selective, never wrong.
+ *
+ * The item array is filled with a counting sort: one pass counts the robots per cell, a prefix sum turns the counts
+ * into offsets and a second pass scatters the robots into place. The scratch arrays are members, so a rebuild
+ * every tick allocates nothing once the robot and cell counts stop growing.
+ */
+void SpatialHash::rebuild(const RobotStore& robots, double width, double height, double cellSize, double slack) {
+    double budget = static_cast<double>(std::min(std::max(minCellBudget, cellsPerRobot * robots.size()),
+                                                 static_cast<size_t>(INT32_MAX)));
+    auto cellsAlong = [](double extent, double size) { return std::max(1.0, std::ceil(extent / size)); };
+    double size = std::max(cellSize, 1.0);
+    if (cellsAlong(width, size) * cellsAlong(height, size) > budget) {
+        size = std::max(size, std::sqrt(width * height / budget));
+        while (cellsAlong(width, size) * cellsAlong(height, size) > budget) {
+            size *= 1.0625;
+        }
+    }
+    this->cellSize = size;
+    this->slack = slack;
+    size_t columnCount = static_cast<size_t>(cellsAlong(width, size));
+    size_t rowCount = static_cast<size_t>(cellsAlong(height, size));
+    size_t cellCount = columnCount * rowCount;
+    columns = static_cast<int>(columnCount);
+    rows = static_cast<int>(rowCount);
+
+    robotCellStart.assign(cellCount + 1, 0);
+    robotCells.resize(robots.size());
+    for (size_t i = 0; i < robots.size(); ++i) {
+        robotCells[i] = static_cast<uint32_t>(static_cast<size_t>(rowOf(robots.y[i])) * static_cast<size_t>(columns)
+                                              + static_cast<size_t>(columnOf(robots.x[i])));
+        ++robotCellStart[robotCells[i] + 1];
+    }
+    for (size_t cell = 0; cell < cellCount; ++cell) {
+        robotCellStart[cell + 1] += robotCellStart[cell];
+    }
+    robotItems.resize(robots.size());
+    cursor.assign(robotCellStart.begin(), robotCellStart.end() - 1);
+    for (size_t i = 0; i < robots.size(); ++i) {
+        robotItems[cursor[robotCells[i]]++] = static_cast<uint32_t>(i);
+    }
+}
+
+/**
+ * @brief Returns the cell column containing an x coordinate.
+ * @param x The x coordinate.
+ * @return Column index, clamped to the grid so that entities outside the environment land in a border cell.
+ */
+int SpatialHash::columnOf(double x) const {
+    int column = static_cast<int>(std::floor(x / cellSize));
+    return std::max(0, std::min(column, columns - 1));
+}
+
+/**
+ * @brief Returns the cell row containing a y coordinate.
+ * @param y The y coordinate.
+ * @return Row index, clamped to the grid so that entities outside the environment land in a border cell.
+ */
+int SpatialHash::rowOf(double y) const {
+    int row = static_cast<int>(std::floor(y / cellSize));
+    return std::max(0, std::min(row, rows - 1));
+}
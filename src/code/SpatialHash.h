@@ -0,0 +1,98 @@
+/**
+ * @file SpatialHash.h
+ * @brief Uniform grid used to find robots near a point of interest.
+ *
+ * The grid covers the environment rectangle and is rebuilt once per simulation tick, so sensor and collision queries
+ * only have to look at robots in the cells around the querying robot instead of scanning the whole environment.
+ * Obstacles are static and are indexed separately by ObstacleTree.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef SPATIALHASH_H
+#define SPATIALHASH_H
+
+#include "RobotStore.h"
+#include "QRectF"
+#include "vector"
+#include "cstddef"
+#include "cstdint"
+#include "algorithm"
+
+/**
+ * @class SpatialHash
+ * @brief Buckets robots into square cells of a fixed size.
+ *
+ * Every robot is stored, as its RobotStore slot, in the single cell containing its centre. Cell contents are kept in
+ * flat arrays (an offset table and an item array), which makes a rebuild two linear passes and a query a walk over a
+ * few contiguous ranges.
+ *
+ * Robots keep moving after the rebuild, so every robot query is widened by the largest distance a robot can travel
+ * in one tick. Queries never modify the grid and may run concurrently.
+ *
+ * The number of cells is capped in proportion to the number of robots. A large, sparsely populated environment gets
+ * cells larger than requested instead of an offset table that dwarfs the robots it indexes.
+ */
+class SpatialHash {
+public:
+    /**
+     * @brief Rebuilds the grid from the current robots.
+     * @param robots Store whose slots are inserted, bucketed by their current position.
+     * @param width Width of the covered area.
+     * @param height Height of the covered area.
+     * @param cellSize Smallest edge length of one cell; grown when the grid would exceed its cell budget.
+     * @param slack Largest distance a robot may move before the next rebuild.
+     */
+    void rebuild(const RobotStore& robots, double width, double height, double cellSize, double slack);
+
+    /**
+     * @brief Calls a function for every robot that may lie inside an area.
+     * @param area Area of interest in environment coordinates.
+     * @param fn Callable taking a RobotStore slot and returning true to stop the search.
+     * @return True if the search was stopped by the callable.
+     */
+    template <typename Fn>
+    bool forEachRobot(const QRectF& area, Fn&& fn) const {
+        if (robotCellStart.empty()) {
+            return false;
+        }
+        QRectF padded = area.adjusted(-slack, -slack, slack, slack);
+        int firstColumn = columnOf(padded.left());
+        int lastColumn = columnOf(padded.right());
+        int firstRow = rowOf(padded.top());
+        int lastRow = rowOf(padded.bottom());
+        for (int row = firstRow; row <= lastRow; ++row) {
+            for (int column = firstColumn; column <= lastColumn; ++column) {
+                size_t cell = static_cast<size_t>(row) * static_cast<size_t>(columns) + static_cast<size_t>(column);
+                for (uint32_t i = robotCellStart[cell]; i < robotCellStart[cell + 1]; ++i) {
+                    if (fn(robotItems[i])) {
+                        return true;
+                    }
+                }
+            }
+        }
+        return false;
+    }
+
+    [[nodiscard]] double getCellSize() const { return cellSize; } /// Edge length of one cell.
+
+private:
+    static constexpr size_t cellsPerRobot = 4; ///< Cells allowed per robot before cells are grown.
+    static constexpr size_t minCellBudget = 4096; ///< Cells always allowed, however few robots there are.
+
+    double cellSize = 1.0; ///< Edge length of one cell.
+    double slack = 0.0; ///< Padding added to robot queries to cover movement since the rebuild.
+    int columns = 0; ///< Number of cells along the x axis.
+    int rows = 0; ///< Number of cells along the y axis.
+
+    std::vector<uint32_t> robotCellStart; ///< Offsets into robotItems, one entry per cell plus an end marker.
+    std::vector<uint32_t> robotItems; ///< Robot slots sorted by cell.
+    std::vector<uint32_t> robotCells; ///< Cell of every robot slot; scratch space of rebuild().
+    std::vector<uint32_t> cursor; ///< Next free position in robotItems for every cell; scratch space of rebuild().
+
+    [[nodiscard]] int columnOf(double x) const; /// Cell column containing an x coordinate, clamped to the grid.
+    [[nodiscard]] int rowOf(double y) const; /// Cell row containing a y coordinate, clamped to the grid.
+};
+
+#endif // SPATIALHASH_H
@@ -0,0 +1,219 @@
+/**
+ * @file TaskScheduler.cpp
+ * @brief Implements the work-stealing scheduler declared in TaskScheduler.h.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "TaskScheduler.h"
+#include "Profiler.h"
+#include "chrono"
+#include "algorithm"
+
+namespace {
+    /// Packs a [first, end) chunk range into one deque word.
+    uint64_t packRange(uint32_t first, uint32_t end) {
+        return (static_cast<uint64_t>(first) << 32) | end;
+    }
+}
+
+/**
+ * @brief Starts the worker threads.
+ * @param threadCount Total number of threads taking part in parallelFor, including the caller.
+ */
+TaskScheduler::TaskScheduler(int threadCount)
+    : threads(threadCount > 1 ? static_cast<size_t>(threadCount) : 1), queues(new Worker[threads]) {
+    workers.reserve(threads - 1);
+    for (size_t worker = 1; worker < threads; ++worker) {
+        workers.emplace_back(&TaskScheduler::workerLoop, this, worker);
+    }
+}
+
+/**
+ * @brief Stops and joins the worker threads.
+ */
+TaskScheduler::~TaskScheduler() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+}
+
+/**
+ * @brief Calls a function on chunks of [0, count) in parallel and waits for all of them.
+ * @param count Number of work items.
+ * @param grain Number of items per chunk; the last chunk may be shorter.
+ * @param body Callable taking the begin and end of a chunk.
+ *
+ * Chunks are dealt out as equal contiguous shares, one per worker, and rebalanced by stealing from then on. The call
+ * returns only after every worker has left the job, so body may refer to the caller's stack.
+ */
+void TaskScheduler::parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body) {
+    auto begin = std::chrono::steady_clock::now();
+    grain = grain > 0 ? grain : 1;
+    size_t chunkCount = (count + grain - 1) / grain;
+
+    if (threads == 1 || chunkCount < 2) {
+        if (count > 0) {
+            body(0, count);
+            queues[0].stats.chunks += 1;
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        queues[0].stats.busySeconds += seconds;
+        elapsedSeconds += seconds;
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t worker = 0; worker < threads; ++worker) {
+            queues[worker].range.store(packRange(static_cast<uint32_t>(chunkCount * worker / threads),
+                                                 static_cast<uint32_t>(chunkCount * (worker + 1) / threads)),
+                                       std::memory_order_relaxed);
+        }
+        job = &body;
+        jobCount = count;
+        jobGrain = grain;
+        pending = static_cast<int>(threads - 1);
+        ++generation;
+    }
+    wake.notify_all();
+
+    runChunks(0, body, count, grain);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return pending == 0; });
+    job = nullptr;
+    elapsedSeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+}
+
+/**
+ * @brief Gets the work done by every worker since the last reset, worker 0 being the calling thread.
+ * @return One entry per worker.
+ */
+std::vector<TaskScheduler::WorkerStats> TaskScheduler::getStats() const {
+    std::vector<WorkerStats> stats;
+    stats.reserve(threads);
+    for (size_t worker = 0; worker < threads; ++worker) {
+        stats.push_back(queues[worker].stats);
+    }
+    return stats;
+}
+
+/**
+ * @brief Clears the statistics of all workers.
+ */
+void TaskScheduler::resetStats() {
+    for (size_t worker = 0; worker < threads; ++worker) {
+        queues[worker].stats = WorkerStats();
+    }
+    elapsedSeconds = 0.0;
+}
+
+/**
+ * @brief Takes the front chunk of a worker's own deque.
+ * @param worker Owner of the deque.
+ * @param chunk Receives the chunk index.
+ * @return False if the deque is empty.
+ */
+bool TaskScheduler::popLocal(size_t worker, uint32_t& chunk) {
+    std::atomic<uint64_t>& range = queues[worker].range;
+    uint64_t current = range.load(std::memory_order_acquire);
+    for (;;) {
+        uint32_t first = static_cast<uint32_t>(current >> 32);
+        uint32_t end = static_cast<uint32_t>(current);
+        if (first >= end) {
+            return false;
+        }
+        if (range.compare_exchange_weak(current, packRange(first + 1, end), std::memory_order_acq_rel)) {
+            chunk = first;
+            return true;
+        }
+    }
+}
+
+/**
+ * @brief Takes the back half of another worker's deque.
+ * @param thief Worker looking for work; its own deque must be empty.
+ * @param chunk Receives the first stolen chunk; the rest of the stolen half goes into the thief's deque.
+ * @return False if every other deque is empty.
+ */
+bool TaskScheduler::steal(size_t thief, uint32_t& chunk) {
+    for (size_t offset = 1; offset < threads; ++offset) {
+        std::atomic<uint64_t>& range = queues[(thief + offset) % threads].range;
+        uint64_t current = range.load(std::memory_order_acquire);
+        for (;;) {
+            uint32_t first = static_cast<uint32_t>(current >> 32);
+            uint32_t end = static_cast<uint32_t>(current);
+            if (first >= end) {
+                break;
+            }
+            uint32_t split = end - (end - first + 1) / 2;
+            if (range.compare_exchange_weak(current, packRange(first, split), std::memory_order_acq_rel)) {
+                chunk = split;
+                queues[thief].range.store(packRange(split + 1, end), std::memory_order_release);
+                ++queues[thief].stats.steals;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Runs chunks until none are left anywhere.
+ * @param worker Worker doing the work.
+ * @param body Body of the job.
+ * @param count Range size of the job.
+ * @param grain Chunk size of the job.
+ */
+void TaskScheduler::runChunks(size_t worker, const std::function<void(size_t, size_t)>& body, size_t count, size_t grain) {
+    WorkerStats& stats = queues[worker].stats;
+    uint32_t chunk;
+    while (popLocal(worker, chunk) || steal(worker, chunk)) {
+        PROFILE_SCOPE(ProfilePhase::Chunk);
+        auto begin = std::chrono::steady_clock::now();
+        size_t first = static_cast<size_t>(chunk) * grain;
+        body(first, std::min(first + grain, count));
+        stats.busySeconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+        ++stats.chunks;
+    }
+}
+
+/**
+ * @brief Waits for jobs and helps with each.
+ * @param worker Index of the worker run by this thread.
+ */
+void TaskScheduler::workerLoop(size_t worker) {
+    Profiler::setThreadName("worker " + std::to_string(worker));
+    unsigned long seen = 0;
+    for (;;) {
+        const std::function<void(size_t, size_t)>* body;
+        size_t count;
+        size_t grain;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            wake.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if (stopping) {
+                return;
+            }
+            seen = generation;
+            body = job;
+            count = jobCount;
+            grain = jobGrain;
+        }
+
+        runChunks(worker, *body, count, grain);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--pending == 0) {
+            done.notify_one();
+        }
+    }
+}
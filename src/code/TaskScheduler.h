@@ -0,0 +1,118 @@
+/**
+ * @file TaskScheduler.h
+ * @brief Work-stealing scheduler that runs chunked index ranges on a fixed set of threads.
+ *
+ * The cost of updating a robot varies a lot: a robot next to a dense obstacle cluster probes far more positions than
+ * one in open space. Splitting a tick into equal blocks per thread leaves cores idle behind the slowest block, so
+ * the range is cut into small chunks instead, and threads that run out of chunks steal from the others.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef TASKSCHEDULER_H
+#define TASKSCHEDULER_H
+
+#include "vector"
+#include "memory"
+#include "thread"
+#include "mutex"
+#include "atomic"
+#include "condition_variable"
+#include "functional"
+#include "cstddef"
+#include "cstdint"
+
+/**
+ * @class TaskScheduler
+ * @brief Runs a range of independent work items on a fixed number of threads with work stealing.
+ *
+ * A scheduler of n threads starts n - 1 workers; the thread calling parallelFor is worker 0 and works along. Every
+ * worker owns a deque of chunk indices, seeded with an equal contiguous share of the chunks. A worker takes chunks
+ * from the front of its own deque; once it is empty, it steals the back half of another worker's deque. Each deque
+ * is a single atomic word holding a [first, last) chunk range, so taking and stealing are one compare-and-swap each.
+ *
+ * Which worker runs which chunk is not deterministic, so the body must give the same result in any order.
+ */
+class TaskScheduler {
+public:
+    /**
+     * @brief Work done by one worker since the last reset.
+     */
+    struct WorkerStats {
+        double busySeconds = 0.0; ///< Time spent inside the body.
+        unsigned long chunks = 0; ///< Chunks executed.
+        unsigned long steals = 0; ///< Successful steals from other workers.
+    };
+
+    /**
+     * @brief Starts the worker threads.
+     * @param threadCount Total number of threads taking part in parallelFor, including the caller.
+     */
+    explicit TaskScheduler(int threadCount);
+
+    /**
+     * @brief Stops and joins the worker threads.
+     */
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    /**
+     * @brief Calls a function on chunks of [0, count) in parallel and waits for all of them.
+     * @param count Number of work items.
+     * @param grain Number of items per chunk; the last chunk may be shorter.
+     * @param body Callable taking the begin and end of a chunk; it must be safe to run on disjoint chunks at once.
+     */
+    void parallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& body);
+
+    /**
+     * @brief Gets the work done by every worker since the last reset, worker 0 being the calling thread.
+     * @return One entry per worker.
+     */
+    [[nodiscard]] std::vector<WorkerStats> getStats() const;
+
+    /**
+     * @brief Gets the wall-clock time spent inside parallelFor since the last reset.
+     * @return Elapsed seconds; a worker's utilization is its busy time divided by this.
+     */
+    [[nodiscard]] double getElapsedSeconds() const { return elapsedSeconds; }
+
+    /**
+     * @brief Clears the statistics of all workers.
+     */
+    void resetStats();
+
+    [[nodiscard]] int getThreadCount() const { return static_cast<int>(threads); } /// Threads taking part, including the caller.
+
+private:
+    /**
+     * @brief Chunk deque and statistics of one worker, kept on their own cache line.
+     */
+    struct alignas(64) Worker {
+        std::atomic<uint64_t> range{0}; ///< First chunk in the high and end chunk in the low 32 bits.
+        WorkerStats stats; ///< Written only by the owning worker while a job runs.
+    };
+
+    size_t threads; ///< Number of workers, including the caller.
+    std::unique_ptr<Worker[]> queues; ///< One deque per worker.
+    std::vector<std::thread> workers; ///< Worker threads; thread i runs worker i + 1.
+    std::mutex mutex; ///< Guards the job fields below.
+    std::condition_variable wake; ///< Signals workers that a new job is available or the scheduler is stopping.
+    std::condition_variable done; ///< Signals the caller that the last worker left the current job.
+    const std::function<void(size_t, size_t)>* job = nullptr; ///< Body of the current job.
+    size_t jobCount = 0; ///< Range size of the current job.
+    size_t jobGrain = 1; ///< Chunk size of the current job.
+    unsigned long generation = 0; ///< Incremented for every job, so workers can tell a new job from a spurious wakeup.
+    int pending = 0; ///< Workers that have not left the current job yet.
+    bool stopping = false; ///< Set by the destructor to end the worker loops.
+    double elapsedSeconds = 0.0; ///< Wall-clock time spent inside parallelFor.
+
+    bool popLocal(size_t worker, uint32_t& chunk); ///< Takes the front chunk of a worker's own deque.
+    bool steal(size_t thief, uint32_t& chunk); ///< Takes the back half of another worker's deque.
+    void runChunks(size_t worker, const std::function<void(size_t, size_t)>& body, size_t count, size_t grain); ///< Runs chunks until none are left anywhere.
+    void workerLoop(size_t worker); ///< Waits for jobs and helps with each.
+};
+
+#endif // TASKSCHEDULER_H
@@ -0,0 +1,76 @@
+/**
+ * @file TripleBuffer.h
+ * @brief Lock-free single-producer, single-consumer triple buffer.
+ *
+ * The simulation thread writes a new frame while the GUI thread reads the last finished one. With three buffers
+ * neither side ever waits for the other: the writer always has a buffer of its own to fill, and the reader always
+ * has a complete frame to draw, however slow either of them is.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#ifndef TRIPLEBUFFER_H
+#define TRIPLEBUFFER_H
+
+#include "atomic"
+#include "cstdint"
+
+/**
+ * @class TripleBuffer
+ * @brief Hands complete values from one writer thread to one reader thread without locks.
+ *
+ * The writer owns the back buffer and the reader owns the front buffer. The third buffer sits in the middle and is
+ * exchanged atomically: publish() swaps the back buffer into the middle and marks it fresh, and update() swaps a
+ * fresh middle buffer to the front. Frames the reader never picked up are simply overwritten, so the reader always
+ * sees the newest complete frame. Buffers are reused, so a T holding vectors keeps its capacity from frame to frame.
+ *
+ * @tparam T Value type; default-constructed three times up front.
+ */
+template <typename T>
+class TripleBuffer {
+public:
+    /**
+     * @brief Gets the buffer the writer fills next. Writer thread only.
+     * @return The back buffer; it still holds whatever was written into it three publishes ago.
+     */
+    T& back() { return buffers[backIndex]; }
+
+    /**
+     * @brief Makes the back buffer the newest complete value and takes over the old middle buffer. Writer thread only.
+     */
+    void publish() {
+        uint8_t previous = middle.exchange(static_cast<uint8_t>(backIndex | freshBit), std::memory_order_acq_rel);
+        backIndex = previous & indexMask;
+    }
+
+    /**
+     * @brief Moves the newest complete value to the front if there is one the reader has not seen. Reader thread only.
+     * @return True if the front buffer changed.
+     */
+    bool update() {
+        if ((middle.load(std::memory_order_relaxed) & freshBit) == 0) {
+            return false;
+        }
+        uint8_t previous = middle.exchange(frontIndex, std::memory_order_acq_rel);
+        frontIndex = previous & indexMask;
+        return true;
+    }
+
+    /**
+     * @brief Gets the value the reader currently holds. Reader thread only.
+     * @return The front buffer, unchanged until the next update().
+     */
+    [[nodiscard]] const T& front() const { return buffers[frontIndex]; }
+
+private:
+    static constexpr uint8_t indexMask = 3; ///< Bits of the middle word holding a buffer index.
+    static constexpr uint8_t freshBit = 4; ///< Set in the middle word while it holds a value the reader has not taken.
+
+    T buffers[3]; ///< The three buffers, indexed by the fields below.
+    alignas(64) std::atomic<uint8_t> middle{1}; ///< Index of the middle buffer plus the fresh bit; shared by both threads.
+    alignas(64) uint8_t backIndex = 0; ///< Index of the writer's buffer.
+    alignas(64) uint8_t frontIndex = 2; ///< Index of the reader's buffer.
+};
+
+#endif // TRIPLEBUFFER_H
@@ -11,6 +11,7 @@
  */
 
 #include <QApplication>
+#include <QThread>
 #include "gui/GuiMain.h"
 #include "Environment.h"
 #include "SimulationEngine.h"
@@ -38,8 +39,17 @@ int main(int argc, char *argv[]) {
 
     SimulationEngine *simulationEngine = new SimulationEngine(&env);  /// Initialize the simulation engine with the environment.
 
+    /// Run the simulation on its own thread, so slow repaints never delay ticks and ticks never delay input handling.
+    QThread simulationThread;
+    simulationEngine->moveToThread(&simulationThread);
+    QObject::connect(&simulationThread, &QThread::finished, simulationEngine, &QObject::deleteLater);
+    simulationThread.start();
+
     GuiMain gui(simulationEngine);  /// Create the main GUI window with the simulation engine.
     gui.show();  /// Display the GUI window.
 
-    return app.exec();  /// Enter the main event loop of the application.
+    int result = app.exec();  /// Enter the main event loop of the application.
+    simulationThread.quit();  /// Let the engine finish its current frame and be deleted before the environment goes away.
+    simulationThread.wait();
+    return result;
 }
\ No newline at end of file
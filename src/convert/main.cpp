@@ -0,0 +1,98 @@
+/**
+ * @file main.cpp
+ * @brief Entry point of the scene converter between the text configuration format and binary scene snapshots.
+ *
+ * A text scene is converted to a snapshot and a snapshot back to text, so large scenes can be authored or
+ * generated as text once and loaded from the snapshot afterwards.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "code/Environment.h"
+#include "code/SceneSnapshot.h"
+#include "chrono"
+#include "fstream"
+#include "iostream"
+#include "string"
+
+/**
+ * @brief Prints the command-line usage of the converter.
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " INPUT OUTPUT" << std::endl
+              << "  Converts a text configuration into a binary scene snapshot, or a snapshot back into text." << std::endl;
+}
+
+/**
+ * @brief Writes the size, robots and obstacles of an environment in the text configuration format.
+ * @param path Path of the file to write.
+ * @param environment Environment to write.
+ * @return False if the file cannot be written.
+ */
+static bool writeText(const std::string& path, Environment& environment) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        return false;
+    }
+    out.precision(17);
+    out << "Environment " << environment.width << " " << environment.height << "\n";
+    for (const auto& robot : environment.getRobots()) {
+        const char* type = robot->getKind() == RobotKind::Remote ? "remote" : "autonomous";
+        out << "Robot " << type << " " << robot->getID() << " "
+            << robot->getPosition().first << " " << robot->getPosition().second << " "
+            << robot->getSpeed() << " " << robot->getOrientation() << " " << robot->getSensorRange() << "\n";
+    }
+    for (const auto& obstacle : environment.getObstacles()) {
+        out << "Obstacle " << obstacle->getId() << " "
+            << obstacle->getPosition().first << " " << obstacle->getPosition().second << " " << obstacle->getBounds().width() << "\n";
+    }
+    out.close();
+    return static_cast<bool>(out);
+}
+
+/**
+ * @brief Main function of the converter.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return Zero on success, non-zero on invalid arguments or an unreadable or unwritable file.
+ */
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::string inputPath = argv[1];
+    std::string outputPath = argv[2];
+    bool toText = SceneSnapshot::isSnapshot(inputPath);
+
+    Environment env;
+    auto begin = std::chrono::steady_clock::now();
+    std::string error;
+    if (toText) {
+        if (!env.loadSnapshot(inputPath, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    } else {
+        std::ifstream probe(inputPath);
+        if (!probe.is_open()) {
+            std::cerr << "Unable to open file: " << inputPath << std::endl;
+            return 1;
+        }
+        env.loadConfiguration(inputPath);
+    }
+    auto loaded = std::chrono::steady_clock::now();
+
+    if (toText ? !writeText(outputPath, env) : !SceneSnapshot::write(outputPath, env, error)) {
+        std::cerr << (toText ? "Unable to write file: " + outputPath : error) << std::endl;
+        return 1;
+    }
+    auto written = std::chrono::steady_clock::now();
+
+    std::cerr << "Converted " << env.getRobots().size() << " robots and " << env.getObstacles().size() << " obstacles"
+              << " (load " << std::chrono::duration<double, std::milli>(loaded - begin).count() << " ms, write "
+              << std::chrono::duration<double, std::milli>(written - loaded).count() << " ms)" << std::endl;
+    return 0;
+}
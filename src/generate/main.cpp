@@ -0,0 +1,142 @@
+/**
+ * @file main.cpp
+ * @brief Entry point of the scene generator, which writes procedural stress scenes as text or binary snapshots.
+ *
+ * The scene comes from SceneGenerator; the output format follows the extension of the output path, so a scene of
+ * a million robots can go straight into a snapshot without a text round trip.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "code/SceneGenerator.h"
+#include "code/SceneSnapshot.h"
+#include "chrono"
+#include "cstdlib"
+#include "cstring"
+#include "iostream"
+#include "string"
+
+/**
+ * @brief Prints the command-line usage of the generator.
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [options] OUTPUT" << std::endl
+              << "  Writes a generated scene to OUTPUT: a binary snapshot if it ends in .rsnap, text otherwise." << std::endl
+              << "  --layout NAME    warehouse, clutter (default), corridor or maze." << std::endl
+              << "  --robots N       Number of robots (default 1000)." << std::endl
+              << "  --size W[xH]     Size of the world (default: square, from the robot count and density)." << std::endl
+              << "  --density D      Robots per 100 x 100 units when the size is derived (default 1)." << std::endl
+              << "  --remote F       Share of remote-controlled robots, 0 to 1 (default 0)." << std::endl
+              << "  --speed S        Speed of every robot (default 2)." << std::endl
+              << "  --sensor-range R Sensor range of every robot (default 40)." << std::endl
+              << "  --spacing S      Edge of one obstacle block (default 20)." << std::endl
+              << "  --clutter F      Share of the world covered by clutter, 0 to 0.9 (default 0.15)." << std::endl
+              << "  --seed N         Seed of the layout and placement (default 1)." << std::endl;
+}
+
+/**
+ * @brief Converts a whole argument to a number.
+ * @param text The argument.
+ * @param value Receives the number.
+ * @return False unless the argument is exactly one number.
+ */
+static bool toNumber(const char* text, double& value) {
+    char* end = nullptr;
+    value = std::strtod(text, &end);
+    return end != text && *end == '\0';
+}
+
+/**
+ * @brief Main function of the generator.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return Zero on success, non-zero on invalid arguments, parameters that do not fit, or an unwritable file.
+ */
+int main(int argc, char *argv[]) {
+    SceneSpec spec;
+    std::string outputPath;
+    for (int i = 1; i < argc; ++i) {
+        const char* option = argv[i];
+        if (option[0] != '-') {
+            if (!outputPath.empty()) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            outputPath = option;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            printUsage(argv[0]);
+            return 1;
+        }
+        const char* value = argv[++i];
+        double number = 0.0;
+        bool valid = true;
+        if (std::strcmp(option, "--layout") == 0) {
+            valid = SceneGenerator::parseLayout(value, spec.layout);
+        } else if (std::strcmp(option, "--size") == 0) {
+            const char* cross = std::strchr(value, 'x');
+            std::string first = cross ? std::string(value, cross) : std::string(value);
+            valid = toNumber(first.c_str(), spec.width) && spec.width > 0;
+            spec.height = spec.width;
+            if (valid && cross) {
+                valid = toNumber(cross + 1, spec.height) && spec.height > 0;
+            }
+        } else if (!toNumber(value, number)) {
+            valid = false;
+        } else if (std::strcmp(option, "--robots") == 0) {
+            valid = number >= 0 && number == static_cast<double>(static_cast<size_t>(number));
+            spec.robots = static_cast<size_t>(number);
+        } else if (std::strcmp(option, "--density") == 0) {
+            spec.density = number;
+        } else if (std::strcmp(option, "--remote") == 0) {
+            spec.remoteFraction = number;
+        } else if (std::strcmp(option, "--speed") == 0) {
+            spec.speed = number;
+        } else if (std::strcmp(option, "--sensor-range") == 0) {
+            spec.sensorRange = number;
+        } else if (std::strcmp(option, "--spacing") == 0) {
+            spec.spacing = number;
+        } else if (std::strcmp(option, "--clutter") == 0) {
+            spec.clutter = number;
+        } else if (std::strcmp(option, "--seed") == 0) {
+            valid = number >= 0;
+            spec.seed = static_cast<uint64_t>(number);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "Invalid option: " << option << " " << value << std::endl;
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+    if (outputPath.empty()) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    auto begin = std::chrono::steady_clock::now();
+    SceneConfig scene;
+    std::string error;
+    if (!SceneGenerator::generate(spec, scene, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    auto generated = std::chrono::steady_clock::now();
+
+    bool binary = outputPath.size() >= 6 && outputPath.compare(outputPath.size() - 6, 6, ".rsnap") == 0;
+    if (binary ? !SceneSnapshot::write(outputPath, scene, error) : !SceneGenerator::writeText(outputPath, scene, error)) {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    auto written = std::chrono::steady_clock::now();
+
+    std::cerr << "Generated " << scene.robots.size() << " robots and " << scene.obstacles.size() << " obstacles in a "
+              << scene.width << " x " << scene.height << " world (generate "
+              << std::chrono::duration<double, std::milli>(generated - begin).count() << " ms, write "
+              << std::chrono::duration<double, std::milli>(written - generated).count() << " ms)" << std::endl;
+    return 0;
+}
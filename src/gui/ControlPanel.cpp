@@ -7,6 +7,8 @@
  * @date 2024-05-05
  */
 #include "ControlPanel.h"
+#include "code/SimulationEngine.h"
+#include "QFontDatabase"
 
 /**
  * @brief Constructs a new ControlPanel object with the specified parent.
@@ -20,6 +22,21 @@ ControlPanel::ControlPanel(QWidget *parent) : QWidget(parent) {
     stopButton = new QPushButton(tr("Stop"), this);
     settingsButton = new QPushButton(tr("Add Configuration"), this);
     loadButton = new QPushButton(tr("Load Configuration"), this);
+    speedLabel = new QLabel(tr("Speed"), this);
+    speedSelector = new QComboBox(this);
+    speedSelector->addItem(tr("1x"), 1.0);
+    speedSelector->addItem(tr("10x"), 10.0);
+    speedSelector->addItem(tr("Max"), SimulationEngine::AsFastAsPossible);
+    profilerCheckBox = new QCheckBox(tr("Profiler"), this);
+    profilerCheckBox->setEnabled(Profiler::compiledIn);
+    dumpProfileButton = new QPushButton(tr("Dump Profile"), this);
+    dumpProfileButton->setEnabled(Profiler::compiledIn);
+    traceCheckBox = new QCheckBox(tr("Record Trace"), this);
+    traceCheckBox->setEnabled(Profiler::compiledIn);
+    profileDump = new QPlainTextEdit(this);
+    profileDump->setReadOnly(true);
+    profileDump->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    profileDump->setMaximumHeight(160);
 
     // Create a vertical layout for the control panel
     QVBoxLayout *layout = new QVBoxLayout(this);
@@ -27,8 +44,14 @@ ControlPanel::ControlPanel(QWidget *parent) : QWidget(parent) {
     layout->addWidget(pauseButton);
     layout->addWidget(resumeButton);
     layout->addWidget(stopButton);
+    layout->addWidget(speedLabel);
+    layout->addWidget(speedSelector);
     layout->addWidget(settingsButton);
     layout->addWidget(loadButton);
+    layout->addWidget(profilerCheckBox);
+    layout->addWidget(dumpProfileButton);
+    layout->addWidget(traceCheckBox);
+    layout->addWidget(profileDump);
     setLayout(layout);
 
     // Connect signals and slots for the control panel buttons
@@ -38,5 +61,13 @@ ControlPanel::ControlPanel(QWidget *parent) : QWidget(parent) {
     connect(stopButton, &QPushButton::clicked, this, &ControlPanel::stopSimulation);
     connect(settingsButton, &QPushButton::clicked, this, &ControlPanel::openSettings);
     connect(loadButton, &QPushButton::clicked, this, &ControlPanel::loadnewConfiguration);
+    connect(speedSelector, QOverload<int>::of(&QComboBox::currentIndexChanged), [this](int index) {
+        emit timeScaleChanged(speedSelector->itemData(index).toDouble());
+    });
+    connect(profilerCheckBox, &QCheckBox::toggled, this, &ControlPanel::profilerToggled);
+    connect(traceCheckBox, &QCheckBox::toggled, this, &ControlPanel::traceToggled);
+    connect(dumpProfileButton, &QPushButton::clicked, [this]() {
+        profileDump->setPlainText(QString::fromStdString(Profiler::instance().report()));
+    });
 
 }
@@ -12,13 +12,19 @@
 #include "QWidget"
 #include "QPushButton"
 #include "QVBoxLayout"
+#include "QComboBox"
+#include "QLabel"
+#include "QCheckBox"
+#include "QPlainTextEdit"
 
 /**
  * @class ControlPanel
  * @brief Represents a control panel for the simulation interface.
  *
  * This class provides a control panel with buttons for starting, pausing, resuming, and stopping the simulation,
- * as well as for opening the settings dialog and loading a new configuration.
+ * a selector for the simulation speed, as well as for opening the settings dialog and loading a new configuration.
+ * A profiler switch toggles the on-screen latency overlay, and the dump button prints the full latency table.
+ * The trace switch records a timeline of the latest ticks, which is saved when it is switched off.
  */
 class ControlPanel : public QWidget {
     Q_OBJECT
@@ -33,6 +39,9 @@ signals:
     void stopSimulation();
     void openSettings();       
     void loadnewConfiguration();   
+    void timeScaleChanged(double scale);
+    void profilerToggled(bool enabled);
+    void traceToggled(bool recording);
 
 private:
     QPushButton *startButton;
@@ -41,6 +50,12 @@ private:
     QPushButton *stopButton;
     QPushButton *settingsButton;
     QPushButton *loadButton;
+    QLabel *speedLabel;
+    QComboBox *speedSelector;
+    QCheckBox *profilerCheckBox;
+    QPushButton *dumpProfileButton;
+    QCheckBox *traceCheckBox;
+    QPlainTextEdit *profileDump;
 };
 
 #endif 
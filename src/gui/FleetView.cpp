@@ -0,0 +1,165 @@
+/**
+ * @file FleetView.cpp
+ * @brief Implementation of the FleetView class, which draws a whole robot fleet as one graphics item.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+#include "FleetView.h"
+#include "RobotView.h"
+
+/**
+ * @brief Construct a new FleetView object
+ *
+ * @param parent Parent item
+ */
+FleetView::FleetView(QGraphicsItem *parent)
+    : QGraphicsItem(parent) {
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);  /// Needed for exposedRect, which culls cones off screen.
+}
+
+/**
+ * @brief Replace the drawn robots with those of a new snapshot
+ *
+ * @param robots Robot poses in slot order
+ */
+void FleetView::setRobots(const std::vector<RobotPose> &robots) {
+    poses.assign(robots.begin(), robots.end());
+    int count = static_cast<int>(poses.size());
+    centres.resize(count);
+    headings.resize(count);
+
+    double reach = robotSize / 2;
+    double minX = 0, minY = 0, maxX = 0, maxY = 0;
+    for (int i = 0; i < count; ++i) {
+        const RobotPose& robot = poses[static_cast<size_t>(i)];
+        double radians = robot.orientation * M_PI / 180;
+        centres[i] = QPointF(robot.x, robot.y);
+        headings[i] = QLineF(robot.x, robot.y, robot.x + robotSize/2 * std::cos(radians), robot.y + robotSize/2 * std::sin(radians));
+        reach = std::max(reach, robot.sensorRange + 10.5);
+        if (i == 0) {
+            minX = maxX = robot.x;
+            minY = maxY = robot.y;
+        } else {
+            minX = std::min(minX, robot.x);
+            maxX = std::max(maxX, robot.x);
+            minY = std::min(minY, robot.y);
+            maxY = std::max(maxY, robot.y);
+        }
+    }
+
+    QRectF newBounds = count > 0 ? QRectF(QPointF(minX - reach, minY - reach), QPointF(maxX + reach, maxY + reach)) : QRectF();
+    if (newBounds != bounds) {
+        prepareGeometryChange();
+        bounds = newBounds;
+    }
+    update();
+}
+
+/**
+ * @brief Find the robot whose body covers a point
+ *
+ * @param point Point in item coordinates, which are scene coordinates
+ * @return Index of the robot for pose(), or -1 if the point hits no robot
+ */
+int FleetView::robotAt(const QPointF &point) const {
+    double radiusSquared = robotSize * robotSize / 4;
+    for (size_t i = poses.size(); i-- > 0;) {  /// Later robots are drawn on top, so they win.
+        double dx = poses[i].x - point.x();
+        double dy = poses[i].y - point.y();
+        if (dx * dx + dy * dy <= radiusSquared) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+/**
+ * @brief Choose how much of each robot to draw
+ *
+ * @param robots Number of robots in the fleet
+ * @param scale Scene-to-screen scale of the view
+ * @return Dots when robots are only a few pixels wide or very many, heading lines at medium size or count, and full
+ * cones only when both robots are large enough and few enough for per-robot paths to stay cheap
+ */
+FleetView::Detail FleetView::chooseDetail(size_t robots, double scale) {
+    double pixels = robotSize * scale;
+    if (pixels < 4 || robots > 50000) {
+        return Detail::Dots;
+    }
+    if (pixels < 12 || robots > 5000) {
+        return Detail::Headings;
+    }
+    return Detail::Cones;
+}
+
+/**
+ * @brief Bounding rectangle of all robots and their cones
+ *
+ * @return QRectF
+ */
+QRectF FleetView::boundingRect() const {
+    return bounds;
+}
+
+/**
+ * @brief Whether a point hits a robot, so clicks between robots reach the items below
+ *
+ * @param point Point in item coordinates
+ * @return bool
+ */
+bool FleetView::contains(const QPointF &point) const {
+    return robotAt(point) >= 0;
+}
+
+/**
+ * @brief Paint the fleet at the level of detail chosen for the current view
+ *
+ * @param painter
+ * @param option
+ * @param widget
+ */
+void FleetView::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
+    Q_UNUSED(widget)
+    double scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    Detail detail = chooseDetail(poses.size(), scale);
+
+    if (detail != Detail::Cones) {
+        QPen dotPen(Qt::gray);
+        dotPen.setCosmetic(true);
+        dotPen.setCapStyle(Qt::RoundCap);
+        dotPen.setWidthF(std::max(2.0, robotSize * scale));
+        painter->setPen(dotPen);
+        painter->drawPoints(centres.constData(), centres.size());
+        if (detail == Detail::Headings) {
+            QPen headingPen(Qt::red);
+            headingPen.setCosmetic(true);
+            painter->setPen(headingPen);
+            painter->drawLines(headings.constData(), headings.size());
+        }
+        return;
+    }
+
+    QRectF exposed = option->exposedRect;
+    painter->setBrush(Qt::gray);
+    for (const RobotPose& robot : poses) {
+        if (exposed.intersects(QRectF(robot.x - robotSize/2, robot.y - robotSize/2, robotSize, robotSize))) {
+            painter->drawEllipse(QRectF(robot.x - robotSize/2, robot.y - robotSize/2, robotSize, robotSize));
+        }
+    }
+
+    painter->setPen(Qt::red);
+    painter->drawLines(headings.constData(), headings.size());
+
+    painter->setBrush(QColor(255, 255, 0, 100));
+    for (const RobotPose& robot : poses) {
+        double reach = robot.sensorRange + 10.5;
+        if (!exposed.intersects(QRectF(robot.x - reach, robot.y - reach, 2 * reach, 2 * reach))) {
+            continue;
+        }
+        painter->translate(robot.x, robot.y);
+        painter->drawPath(RobotView::conePath(robot.sensorRange, robot.orientation));
+        painter->translate(-robot.x, -robot.y);
+    }
+}
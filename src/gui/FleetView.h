@@ -0,0 +1,62 @@
+/**
+ * @file FleetView.h
+ * @brief Single graphics item that draws a whole robot fleet from contiguous arrays.
+ *
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+#ifndef FLEETVIEW_H
+#define FLEETVIEW_H
+
+#include "QPen"
+#include "QLineF"
+#include "QPointF"
+#include "QVector"
+#include "QPainter"
+#include "QGraphicsItem"
+#include "QStyleOptionGraphicsItem"
+#include "code/RenderSnapshot.h"
+#include "vector"
+#include "cmath"
+
+/**
+ * @brief Draws every robot of a large fleet as one QGraphicsItem.
+ *
+ * With one item per robot, QGraphicsScene spends more time on per-item bookkeeping than on drawing once the fleet
+ * reaches a few thousand robots. This item keeps the centres and heading lines in contiguous arrays and draws them
+ * with a handful of QPainter calls. The level of detail follows the size of a robot on screen and the fleet size:
+ * dots only, then dots with heading lines, then full bodies with sensor cones.
+ */
+class FleetView : public QGraphicsItem {
+public:
+    /**
+     * @brief How much of each robot is drawn.
+     */
+    enum class Detail {
+        Dots, ///< One point per robot.
+        Headings, ///< A point and the heading line.
+        Cones ///< Body, heading line and sensor cone, as RobotView draws them.
+    };
+
+    explicit FleetView(QGraphicsItem *parent = nullptr);
+
+    void setRobots(const std::vector<RobotPose> &robots);
+    [[nodiscard]] int robotAt(const QPointF &point) const;
+    [[nodiscard]] const RobotPose& pose(int index) const { return poses[static_cast<size_t>(index)]; }
+    [[nodiscard]] static Detail chooseDetail(size_t robots, double scale);
+
+    [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] bool contains(const QPointF &point) const override;
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
+
+private:
+    std::vector<RobotPose> poses; ///< Robots as of the last snapshot.
+    QVector<QPointF> centres; ///< Robot centres, contiguous for drawPoints.
+    QVector<QLineF> headings; ///< Heading lines from each centre, contiguous for drawLines.
+    QRectF bounds; ///< Area covered by all robots and their cones.
+
+    static constexpr double robotSize = 20; ///< Robot diameter, as in RobotView.
+};
+
+#endif // FLEETVIEW_H
@@ -19,6 +19,7 @@ GuiMain::GuiMain(SimulationEngine* engine, QWidget* parent)
     settingsDialog = new SettingsDialog(this);
     loadNew = new LoadEnvironment(engine->getEnvironment(), this);
     QObject::connect(loadNew, &LoadEnvironment::stopEngine, engine, &SimulationEngine::stop);
+    QObject::connect(loadNew, &LoadEnvironment::environmentReloaded, engine, &SimulationEngine::refresh);
     setCentralWidget(simulationWindow);
     QDockWidget* dockWidget = new QDockWidget(this);
     dockWidget->setWidget(controlPanel);
@@ -43,6 +44,9 @@ void GuiMain::setupConnections() {
     connect(controlPanel, &ControlPanel::openSettings, this, &GuiMain::openSettingsDialog);
     connect(controlPanel, &ControlPanel::stopSimulation, this, &GuiMain::stopSimulation);
     connect(controlPanel, &ControlPanel::loadnewConfiguration, this, &GuiMain::loadNewConf);
+    connect(controlPanel, &ControlPanel::timeScaleChanged, engine, &SimulationEngine::setTimeScale);
+    connect(controlPanel, &ControlPanel::profilerToggled, simulationWindow, &SimulationWindow::setProfilerOverlayVisible);
+    connect(controlPanel, &ControlPanel::traceToggled, simulationWindow, &SimulationWindow::setTraceRecording);
 }
 /**
  * @brief Opens the settings dialog.
@@ -10,6 +10,9 @@
 #include "code/ConfigManager.h"
 #include "code/AutonomousRobot.h"
 #include "code/RemoteControlledRobot.h"
+#include "code/SceneSnapshot.h"
+#include "code/ConfigParser.h"
+#include "code/Profiler.h"
 #include "LoadEnvironment.h"
 
 /**
@@ -21,7 +24,7 @@ LoadEnvironment::LoadEnvironment(Environment* env, QObject* parent)
     : QObject(parent), environment(env) {}
 
 void LoadEnvironment::loadNewConfiguration() {
-    QString filePath = QFileDialog::getOpenFileName(nullptr, QObject::tr("Open configuration"), QDir::homePath(), QObject::tr("Configurations (*.txt)"));
+    QString filePath = QFileDialog::getOpenFileName(nullptr, QObject::tr("Open configuration"), QDir::homePath(), QObject::tr("Configurations (*.txt);;Scene snapshots (*.rsnap)"));
 
     if (filePath.isEmpty()) {
         return;
@@ -29,68 +32,55 @@ void LoadEnvironment::loadNewConfiguration() {
 
     /// Stop the engine before loading a new configuration.
     emit stopEngine();
-    environment->clear();
-    QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    PROFILE_SCOPE(ProfilePhase::ConfigLoad);
+    std::string path = filePath.toStdString();
+    bool snapshot = SceneSnapshot::isSnapshot(path);
+
+    /// Text is parsed before the environment is locked, so the simulation thread only waits while entities are added.
+    SceneConfig config;
+    std::string readError;
+    if (!snapshot && !ConfigParser::parseFile(path, config, readError)) {
         QMessageBox::critical(nullptr, QObject::tr("Error"), QObject::tr("Could not open file: ") + filePath);
-        emit stopEngine();
         return;
     }
 
-    QTextStream in(&file);
-    QString line;
     bool success = true;
+    QString error;
 
-    /// Read the configuration file line by line.
-    while (!in.atEnd()) {
-        line = in.readLine();
-        QStringList parts = line.split(QRegularExpression("\\s+"), Qt::SkipEmptyParts);
-
-        /// Check if the line is not empty and has the correct format.
-        if (parts.count() > 1) {
-            if (parts[0] == "Robot" && parts.count() >= 8) {
-                QString robotType = parts[1];
-                int id = parts[2].toInt();
-                double x = parts[3].toDouble();
-                double y = parts[4].toDouble();
-                double speed = parts[5].toDouble();
-                double direction = parts[6].toDouble();
-                double sensorRange = parts[7].toDouble();
-
-                /// Create a new robot object based on the type specified in the configuration file.
-                if (robotType == "autonomous") {
-                    auto robot = std::make_unique<AutonomousRobot>(id, std::make_pair(x, y), speed, direction, sensorRange, 800, 600, environment);
-                    environment->addRobot(std::move(robot));
-                } else if (robotType == "remote") {
-                    auto robot = std::make_unique<RemoteControlledRobot>(id, std::make_pair(x, y), speed, direction, sensorRange, environment);
-                    environment->addRobot(std::move(robot));
-                }
-
-            } else if (parts[0] == "Obstacle" && parts.count() == 5) { /// Add a new obstacle to the environment.
-                int id = parts[1].toInt();
-                double x = parts[2].toDouble();
-                double y = parts[3].toDouble();
-                double size = parts[4].toDouble();
-
-                auto obstacle = std::make_unique<Obstacle>(id, std::make_pair(x, y), size);
-                environment->addObstacle(std::move(obstacle));
+    /// The stop request is queued to the simulation thread, which may still be in a frame; the environment's lock
+    /// keeps it out until the new contents are in place. No dialog is shown while the lock is held.
+    std::unique_lock<std::mutex> lock(environment->getMutex());
+    environment->clear();
 
-            } else {
-                success = false;
-                QMessageBox::critical(nullptr, QObject::tr("Error"), QObject::tr("Incorrect configuration string format: ") + line);
-                break; 
-            }
+    if (snapshot) {
+        /// A binary snapshot is mapped and loaded in one go instead of being parsed.
+        std::string snapshotError;
+        success = environment->loadSnapshot(path, snapshotError);
+        error = QString::fromStdString(snapshotError);
+    } else {
+        /// Malformed lines reject the whole file; so do duplicate identifiers, which only show up while adding.
+        std::vector<ConfigError> errors = config.errors;
+        if (errors.empty()) {
+            environment->addConfiguration(config, errors);
+        }
+        if (!errors.empty()) {
+            success = false;
+            error = QObject::tr("Line %1: %2").arg(errors.front().line).arg(QString::fromStdString(errors.front().message));
         }
     }
 
-    file.close();
+    if (!success) {
+        environment->clear();
+        environment->loadConfiguration("examples/example1.txt");
+    }
+    lock.unlock();
+    emit environmentReloaded();
 
     /// Set the configuration path if the configuration was loaded successfully.
     if (success) {
         ConfigManager::setConfigPath(filePath);
     } else {
-        environment->loadConfiguration("examples/example1.txt");
+        QMessageBox::critical(nullptr, QObject::tr("Error"), error);
         emit stopEngine();
     }
 }
-
@@ -9,10 +9,9 @@
 #include "code/Environment.h"
 #include "QObject"
 #include "QFileDialog"
-#include "QTextStream"
 #include "QMessageBox"
-#include "QRegularExpression"
 #include "memory"
+#include "mutex"
 
 /**
  * @brief The LoadEnvironment class is responsible for loading a new environment configuration from a file.
@@ -28,6 +27,7 @@ public slots:
 
 signals:
     void stopEngine();
+    void environmentReloaded(); ///< The environment's contents were replaced; the engine must publish them.
 
 private:
     Environment* environment;
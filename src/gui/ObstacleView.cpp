@@ -29,6 +29,19 @@ QRectF ObstacleView::boundingRect() const {
     return bounds;
 }
 
+/**
+ * @brief Set the bounds of the obstacle, repainting only if they changed
+ *
+ * @param newBounds New bounds in scene coordinates
+ */
+void ObstacleView::setBounds(const QRectF &newBounds) {
+    if (newBounds == bounds) {
+        return;
+    }
+    prepareGeometryChange();
+    bounds = newBounds;
+}
+
 /**
  * @brief Set the position of the obstacle
  *
@@ -31,9 +31,13 @@ public:
     [[nodiscard]] double getSize() const;
     [[nodiscard]] QPointF getPosition() const;
     [[nodiscard]] QRectF boundingRect() const override;
+    void setBounds(const QRectF &newBounds);
+    void setHandle(SlotHandle handle) { this->handle = handle; }
+    [[nodiscard]] SlotHandle getHandle() const { return handle; }
 
 private:
     int id;
+    SlotHandle handle; ///< Handle of the obstacle in the engine, used to edit or remove exactly this obstacle.
     QRectF bounds;
     SimulationEngine* engine;
 
@@ -8,6 +8,91 @@
  */
 #include "RobotView.h"
 
+namespace {
+    /// Cone paths shared by all robot views, keyed by rounded sensor range and whole-degree orientation.
+    QHash<quint64, QPainterPath> coneCache;
+    /// Upper bound on cached cones; reached only if ranges keep changing, and then the cache simply starts over.
+    constexpr int maxCachedCones = 4096;
+    /// Body sprites shared by all robot views, keyed by rounded body size and whole-degree orientation.
+    QHash<quint64, QPixmap> spriteCache;
+
+    /// Orientation rounded to a whole degree in [0, 360).
+    int degreeBucket(double orientation) {
+        int bucket = static_cast<int>(std::lround(orientation)) % 360;
+        return bucket < 0 ? bucket + 360 : bucket;
+    }
+}
+
+/**
+ * @brief Get the sensor cone for a range and orientation, building it on first use
+ *
+ * Orientation is bucketed to whole degrees, which is below what the 60 degree cone can show on screen. The path is
+ * shared by every view with the same range and bucket, and by FleetView.
+ *
+ * @param range Sensor range
+ * @param orientation Orientation in degrees
+ * @return QPainterPath
+ */
+QPainterPath RobotView::conePath(double range, double orientation) {
+    int bucket = degreeBucket(orientation);
+    long rangeKey = std::lround(range);
+    quint64 key = (static_cast<quint64>(static_cast<quint32>(rangeKey)) << 32) | static_cast<quint32>(bucket);
+    auto it = coneCache.constFind(key);
+    if (it != coneCache.constEnd()) {
+        return it.value();
+    }
+
+    double reach = rangeKey + 10;
+    double sweepLength = 60;
+    double startAngle = -(bucket - 30) - sweepLength;
+    QPainterPath path;
+    path.moveTo(0, 0);
+    path.arcTo(QRectF(-reach, -reach, 2 * reach, 2 * reach), startAngle, sweepLength);
+    path.closeSubpath();
+
+    if (coneCache.size() >= maxCachedCones) {
+        coneCache.clear();
+    }
+    coneCache.insert(key, path);
+    return path;
+}
+
+/**
+ * @brief Get the sprite of a robot body with its heading line, rendering it on first use
+ *
+ * Only the body is cached as a pixmap: it is a few hundred bytes per orientation, so all 360 of a size fit in well
+ * under a megabyte however many robots share them. The sensor cone is far larger and is drawn as a path instead.
+ *
+ * @param size Diameter of the body
+ * @param orientation Orientation in degrees, bucketed to whole degrees like the cone
+ * @return QPixmap whose centre is the centre of the robot
+ */
+QPixmap RobotView::bodySprite(double size, double orientation) {
+    int bucket = degreeBucket(orientation);
+    long sizeKey = std::lround(size);
+    quint64 key = (static_cast<quint64>(static_cast<quint32>(sizeKey)) << 32) | static_cast<quint32>(bucket);
+    auto it = spriteCache.constFind(key);
+    if (it != spriteCache.constEnd()) {
+        return it.value();
+    }
+
+    /// One pixel of margin on each side for the outline.
+    int extent = static_cast<int>(sizeKey) + 2;
+    QPixmap sprite(extent, extent);
+    sprite.fill(Qt::transparent);
+    QPainter painter(&sprite);
+    painter.translate(extent / 2.0, extent / 2.0);
+    painter.setBrush(Qt::gray);
+    painter.drawEllipse(QRectF(-sizeKey / 2.0, -sizeKey / 2.0, sizeKey, sizeKey));
+    double radians = bucket * M_PI / 180;
+    painter.setPen(Qt::red);
+    painter.drawLine(QPointF(0, 0), QPointF(sizeKey / 2.0 * std::cos(radians), sizeKey / 2.0 * std::sin(radians)));
+    painter.end();
+
+    spriteCache.insert(key, sprite);
+    return sprite;
+}
+
 /**
  * @brief Construct a new RobotView object
  *
@@ -16,8 +101,9 @@
  * @param parent
  */
 RobotView::RobotView(SimulationEngine* engine, int id, QGraphicsItem *parent)
-    : QGraphicsItem(parent), id(id), engine(engine), size(20), orientation(0), sensorRange(100)  {
+    : QGraphicsItem(parent), id(id), engine(engine), size(20), speed(0), orientation(0), sensorRange(100)  {
     setPosition(QPointF(0, 0));
+    updateGeometryCache();
 }
 
 /**
@@ -35,7 +121,7 @@ int RobotView::getId() const {
  * @return double
  */
 double RobotView::getSpeed() const {
-    return robot->getSpeed();
+    return speed;
 }
 
 /**
@@ -44,7 +130,7 @@ double RobotView::getSpeed() const {
  * @return double
  */
 double RobotView::getOrientation() const {
-    return robot->getOrientation();
+    return orientation;
 }
 
 /**
@@ -53,7 +139,7 @@ double RobotView::getOrientation() const {
  * @return double
  */
 double RobotView::getSensorRange() const {
-    return robot->getRange();
+    return sensorRange;
 }
 
 /**
@@ -69,8 +155,12 @@ QPointF RobotView::getPosition() const {
  * @brief set sensor range
  */
 void RobotView::setSensorRange(double range) {
+    if (range == sensorRange) {
+        return;
+    }
+    prepareGeometryChange();
     sensorRange = range;
-    update();
+    updateGeometryCache();
 }
 
 /**
@@ -89,22 +179,54 @@ void RobotView::setPosition(const QPointF &pos) {
  * @param angle
  */
 void RobotView::setOrientation(double angle) {
+    if (angle == orientation) {
+        return;
+    }
     orientation = angle;
+    updateGeometryCache();
     update();
 }
 
-void RobotView::setRobot(Robot* robot) {
-    if (robot) {
-        this->robot = robot;
-        this->robotId = robot->getID();
-    } else {
-        this->robot = nullptr;
-    }
+/**
+ * @brief Look up the body sprite and the sensor cone after the orientation or range changed
+ */
+void RobotView::updateGeometryCache() {
+    sprite = bodySprite(size, orientation);
+    cone = conePath(sensorRange, orientation);
+}
+
+/**
+ * @brief Set the speed of the robot, shown when the robot is edited
+ *
+ * @param value
+ */
+void RobotView::setSpeed(double value) {
+    speed = value;
 }
 
 
+/**
+ * @brief Bounding rectangle of the robot, including the sensor cone
+ *
+ * The cone reaches sensorRange + 10 from the centre, so the rectangle must cover it for Qt to repaint the old and
+ * new area correctly when a persistent view moves. The cached cone rounds the range, hence the extra half unit.
+ *
+ * @return QRectF
+ */
 QRectF RobotView::boundingRect() const {
-    return QRectF(-size/2, -size/2, size, size);  
+    double reach = std::max(size / 2, sensorRange + 10.5);
+    return QRectF(-reach, -reach, 2 * reach, 2 * reach);
+}
+
+/**
+ * @brief Shape used for hit tests, which is only the robot body and not the sensor cone
+ *
+ * @return QPainterPath
+ */
+QPainterPath RobotView::shape() const {
+    QPainterPath path;
+    path.addEllipse(QRectF(-size/2, -size/2, size, size));
+    return path;
 }
 
 /**
@@ -117,23 +239,9 @@ QRectF RobotView::boundingRect() const {
 void RobotView::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) {
     Q_UNUSED(option)
     Q_UNUSED(widget)
-    painter->setBrush(Qt::gray);
-    painter->drawEllipse(boundingRect());
+    painter->drawPixmap(QPointF(-sprite.width() / 2.0, -sprite.height() / 2.0), sprite);
 
     painter->setPen(Qt::red);
-    painter->drawLine(QPointF(0, 0), QPointF(size/2 * cos(orientation * M_PI / 180), size/2 * sin(orientation * M_PI / 180)));
-
-    QPainterPath path;
-    path.moveTo(0, 0);
-    double startAngle = orientation - 30;  
-    double sweepLength = 60;  
-
-
-    startAngle = -startAngle - sweepLength;
-    QRectF rectangle(-(sensorRange + 10), -(sensorRange + 10), 2 * (sensorRange + 10), 2 * (sensorRange + 10));
-    path.arcTo(rectangle, startAngle, sweepLength);
-
-    path.closeSubpath();
     painter->setBrush(QColor(255, 255, 0, 100));  
-    painter->drawPath(path);
+    painter->drawPath(cone);
 }
@@ -9,11 +9,13 @@
  #ifndef ROBOTVIEW_H
 #define ROBOTVIEW_H
 
-#include "code/Robot.h"
 #include "code/SimulationEngine.h"
 #include "QDebug"
 #include "QPointF"
 #include "QPainter"
+#include "QPainterPath"
+#include "QPixmap"
+#include "QHash"
 #include "QGraphicsItem"
 #include "QGraphicsEllipseItem"
 #include "cmath"
@@ -29,6 +31,7 @@ public:
 
     [[nodiscard]] QPointF getPosition() const;
     [[nodiscard]] QRectF boundingRect() const override;
+    [[nodiscard]] QPainterPath shape() const override;
 
     [[nodiscard]] int getId() const;
 
@@ -36,24 +39,33 @@ public:
     [[nodiscard]] double getOrientation() const;
     [[nodiscard]] double getSensorRange() const;
 
-    void setRobot(Robot* robot);
+    void setSpeed(double speed);
+    void setHandle(SlotHandle handle) { this->handle = handle; }
+    [[nodiscard]] SlotHandle getHandle() const { return handle; }
     void setOrientation(double angle);
     void setSensorRange(double range);
     void setPosition(const QPointF &position);
     void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget) override;
 
+    static QPainterPath conePath(double range, double orientation);
+    static QPixmap bodySprite(double size, double orientation);
+
 private:
     int id;
-    int robotId;
+    SlotHandle handle; ///< Handle of the robot in the engine, used to edit or remove exactly this robot.
 
-    Robot* robot;
     QPointF position;
     SimulationEngine* engine;
 
     double size;
+    double speed;
     double orientation;
     double sensorRange;
 
+    QPixmap sprite; ///< Body and heading line, shared with every view of the same size and orientation.
+    QPainterPath cone; ///< Sensor cone shared with every view of the same range and orientation.
+
+    void updateGeometryCache();
 };
 
 #endif // ROBOTVIEW_H
@@ -7,6 +7,8 @@
  * @date 2024-05-05
  */
 #include "SimulationWindow.h"
+#include "QFontDatabase"
+#include "code/Logger.h"
 
 /**
  * @brief Constructor for the SimulationWindow class.
@@ -16,6 +18,7 @@
 SimulationWindow::SimulationWindow(SimulationEngine *engine, QWidget *parent)
         : QWidget(parent), engine(engine) {
     scene = new QGraphicsScene(this);
+    scene->setItemIndexMethod(QGraphicsScene::NoIndex);  /// Robots move every frame, so a BSP index would be rebuilt constantly.
     view = new QGraphicsView(scene, this);
     view->setSceneRect(0, 0, 800, 600);
     view->setFixedSize(820, 620);
@@ -24,6 +27,16 @@ SimulationWindow::SimulationWindow(SimulationEngine *engine, QWidget *parent)
     layout->addWidget(view);
     setLayout(layout);
 
+    profilerOverlay = new QLabel(view->viewport());
+    profilerOverlay->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    profilerOverlay->setStyleSheet("QLabel { background-color: rgba(0, 0, 0, 160); color: white; padding: 4px; }");
+    profilerOverlay->setAttribute(Qt::WA_TransparentForMouseEvents);
+    profilerOverlay->move(4, 4);
+    profilerOverlay->hide();
+    profilerTimer = new QTimer(this);
+    Profiler::setThreadName("gui");
+    connect(profilerTimer, &QTimer::timeout, this, &SimulationWindow::collectProfile);
+
     initializeScene();
     connect(engine, &SimulationEngine::updateGUI, this, &SimulationWindow::updateScene);
 }
@@ -38,33 +51,36 @@ void SimulationWindow::contextMenuEvent(QContextMenuEvent *event) {
 
     QMenu menu;
 
-    if (item) {
+    /// Copy what the actions need now rather than keeping the item: later snapshots may replace or delete views
+    /// while the menu is open, and a stale handle tells the engine the entity is gone by the time an action runs.
+    MenuTarget target;
+    if (fleetView && item == fleetView) {
+        const RobotPose& pose = fleetView->pose(fleetView->robotAt(scenePoint));
+        target = MenuTarget{MenuTarget::Robot, pose.handle, pose.id, pose.speed, pose.orientation, pose.sensorRange, 0,
+                            QPointF(pose.x, pose.y)};
+    } else if (auto robotView = dynamic_cast<RobotView*>(item)) {
+        target = MenuTarget{MenuTarget::Robot, robotView->getHandle(), robotView->getId(), robotView->getSpeed(),
+                            robotView->getOrientation(), robotView->getSensorRange(), 0, robotView->getPosition()};
+    } else if (auto obstacleView = dynamic_cast<ObstacleView*>(item)) {
+        target = MenuTarget{MenuTarget::Obstacle, obstacleView->getHandle(), obstacleView->getId(), 0, 0, 0,
+                            obstacleView->getSize(), obstacleView->getPosition()};
+    }
+
+    if (target.kind != MenuTarget::None) {
         emit pauseSimulation();
         QAction* removeAction = menu.addAction("Delete Object");
         QAction* modifyAction = menu.addAction("Edit Object");
-        connect(removeAction, &QAction::triggered, [this, item]() {
-            std::cout << "Attempting to remove an item from the scene." << std::endl;
-            if (item && scene->items().contains(item)) {
-                std::cout << "Item is valid and exists in the scene." << std::endl;
-                if (auto robotView = dynamic_cast<RobotView*>(item)) {
-                    int robotId = robotView->getId();
-                    std::cout << "Request to remove robot with ID: " << robotId << std::endl;
-                    engine->removeRobot(robotId);
-                    emit continueSimulation();
-                } else if (auto obstacleView = dynamic_cast<ObstacleView*>(item)) {
-                    int obstacleId = obstacleView->getId();
-                    engine->removeObstacle(obstacleId);
-                    emit continueSimulation();
-                } else {
-                    emit continueSimulation();
-                }
-                scene->removeItem(item);
-                delete item;
+        connect(removeAction, &QAction::triggered, [this, target]() {
+            /// The view itself goes away with the next snapshot, once the engine thread has removed the entity.
+            if (target.kind == MenuTarget::Robot) {
+                LOG_DEBUG("Request to remove robot with ID: " << target.id);
+                engine->removeRobot(target.handle);
             } else {
-                std::cout << "Item is invalid or does not exist in the scene." << std::endl;
+                engine->removeObstacle(target.handle);
             }
+            emit continueSimulation();
         });
-        connect(modifyAction, &QAction::triggered, [this, item]() { modifyItem(item); });
+        connect(modifyAction, &QAction::triggered, [this, target]() { modifyItem(target); });
 
     } else {
         QAction* addRobotAction = menu.addAction("Add Robot");
@@ -84,16 +100,16 @@ void SimulationWindow::handleKeyPress(QKeyEvent *event) {
 
     switch (event->key()) {
         case Qt::Key_Up:
-            engine->sendCommand("start_move_forward");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StartMoveForward));
             break;
         case Qt::Key_Down:
-            engine->sendCommand("start_move_backward");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StartMoveBackward));
             break;
         case Qt::Key_Left:
-            engine->sendCommand("start_turn_left");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StartTurnLeft));
             break;
         case Qt::Key_Right:
-            engine->sendCommand("start_turn_right");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StartTurnRight));
             break;
         default:
             QWidget::keyPressEvent(event);
@@ -109,16 +125,16 @@ void SimulationWindow::handleKeyRelease(QKeyEvent *event) {
 
     switch (event->key()) {
         case Qt::Key_Up:
-            engine->sendCommand("stop_move_forward");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StopMoveForward));
             break;
         case Qt::Key_Down:
-            engine->sendCommand("stop_move_backward");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StopMoveBackward));
             break;
         case Qt::Key_Left:
-            engine->sendCommand("stop_turn_left");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StopTurnLeft));
             break;
         case Qt::Key_Right:
-            engine->sendCommand("stop_turn_right");
+            engine->sendCommand(RobotCommand::toAll(CommandOpcode::StopTurnRight));
             break;
         default:
             QWidget::keyReleaseEvent(event);
@@ -138,11 +154,6 @@ void SimulationWindow::addRobot() {
         double orientation = dialog.getOrientation();
         double sensorSize = dialog.getSensorSize();
         engine->addRobot(type, id, position, speed, orientation, sensorSize);
-        QGraphicsEllipseItem* robotItem = new QGraphicsEllipseItem(
-                position.x() - 10, position.y() - 10, 20, 20
-        );
-        robotItem->setBrush(Qt::blue);
-        scene->addItem(robotItem);
     }
 }
 
@@ -157,89 +168,125 @@ void SimulationWindow::addObstacle() {
         double size = dialog.getSize();
 
         engine->addObstacle(id, position, size);
-
-        QGraphicsRectItem* obstacleItem = new QGraphicsRectItem(
-                position.x() - size / 2, position.y() - size / 2, size, size
-        );
-        obstacleItem->setBrush(Qt::gray);
-        scene->addItem(obstacleItem);
     }
 }
 
 /**
- * @brief Modify an item in the scene.
+ * @brief Modify a robot or obstacle picked from the context menu.
  */
-void SimulationWindow::modifyItem(QGraphicsItem* item) {
-    if (auto robotView = dynamic_cast<RobotView*>(item)) {
+void SimulationWindow::modifyItem(const MenuTarget &target) {
+    if (target.kind == MenuTarget::Robot) {
         RobotDialog dialog(clickPosition, this);
-        dialog.setInitialValues(robotView->getId(), robotView->getSpeed(), robotView->getOrientation(), robotView->getSensorRange(), robotView->getPosition());
+        dialog.setInitialValues(target.id, target.speed, target.orientation, target.sensorRange, target.position);
         if (dialog.exec() == QDialog::Accepted) {
-            engine->updateRobot(robotView->getId(), dialog.getSpeed(), dialog.getOrientation(), dialog.getSensorSize(), dialog.getPosition().x(), dialog.getPosition().y());
+            engine->updateRobot(target.handle, dialog.getSpeed(), dialog.getOrientation(), dialog.getSensorSize(), dialog.getPosition().x(), dialog.getPosition().y());
         }
-    } else if (auto obstacleView = dynamic_cast<ObstacleView*>(item)) {
+    } else if (target.kind == MenuTarget::Obstacle) {
         ObstacleDialog dialog(clickPosition, this);
-        dialog.setInitialSize(obstacleView->getId(), obstacleView->getSize(), obstacleView->getPosition());
+        dialog.setInitialSize(target.id, target.size, target.position);
         if (dialog.exec() == QDialog::Accepted) {
-            engine->updateObstacle(obstacleView->getId(), dialog.getSize(), dialog.getPosition().x(), dialog.getPosition().y());
+            engine->updateObstacle(target.handle, dialog.getSize(), dialog.getPosition().x(), dialog.getPosition().y());
         }
     }
-    updateScene();
 }
 
 /**
  * @brief Initialize the scene with robots and obstacles.
- * @details This method is called when the simulation window is created.
+ * @details This method is called when the simulation window is created. It drops all views and builds them anew.
  */
 void SimulationWindow::initializeScene() {
     scene->clear();
     robotViews.clear();
     obstacleViews.clear();
-    auto robots = engine->getRobots();
-    for (const auto& robot : robots) {
-        RobotView* robotView = new RobotView(engine, robot->getID(), nullptr);
-        robotView->setPos(QPointF(robot->getPosition().first, robot->getPosition().second));
-        robotView->setRotation(robot->getOrientation());
-        robotView->setSensorRange(robot->getSensorRange());
-        robotView->setRobot(robot);
-        scene->addItem(robotView);
-        robotViews.insert(robot->getID(), robotView);
-    }
-
-    auto obstacles = engine->getObstacles();
-    for (const auto& obstacle : obstacles) {
-        ObstacleView* obstacleView = new ObstacleView(engine, obstacle->getId(), obstacle->getBounds(), nullptr);
-        scene->addItem(obstacleView);
-        obstacleViews.insert(obstacle->getId(), obstacleView);
-    }
+    fleetView = nullptr;
+    drawnObstacleRevision = 0;
+    updateScene();
 }
 
 /**
  * @brief Update the scene with the current state of the simulation.
- * @details This method is called when the simulation engine emits the updateGUI signal.
+ * @details This method is called when the simulation engine emits the updateGUI signal. It draws only from the
+ * engine's latest snapshot and never touches the environment, which belongs to the simulation thread. Views persist
+ * between frames: existing ones only get their pose refreshed, and views are created or deleted only for entities
+ * that appeared or disappeared since the previous frame. Obstacles are revisited only when their revision changed.
+ * Fleets larger than fleetThreshold are drawn by a single FleetView instead of one RobotView per robot.
  */
 void SimulationWindow::updateScene() {
-    scene->clear();
-    robotViews.clear();
-    obstacleViews.clear();
+    PROFILE_SCOPE(ProfilePhase::SceneUpdate);
+    const RenderSnapshot& snapshot = engine->latestSnapshot();
+    QSet<int> present;
 
-    auto robots = engine->getRobots();
-    for (const auto& robot : robots) {
-        RobotView* robotView = new RobotView(engine, robot->getID(), nullptr);
-        robotView->setPosition(QPointF(robot->getPosition().first, robot->getPosition().second));
-        robotView->setOrientation(robot->getOrientation());
-        robotView->setSensorRange(robot->getSensorRange());
-        robotView->setRobot(robot);
-        scene->addItem(robotView);
-        robotViews.insert(robot->getID(), robotView);
+    if (snapshot.robots.size() > fleetThreshold) {
+        /// Past a few thousand items the scene's per-item bookkeeping costs more than drawing; switch to one item.
+        if (!fleetView) {
+            for (RobotView* robotView : robotViews) {
+                scene->removeItem(robotView);
+                delete robotView;
+            }
+            robotViews.clear();
+            fleetView = new FleetView(nullptr);
+            fleetView->setZValue(1);
+            scene->addItem(fleetView);
+        }
+        fleetView->setRobots(snapshot.robots);
+    } else {
+        if (fleetView) {
+            scene->removeItem(fleetView);
+            delete fleetView;
+            fleetView = nullptr;
+        }
+        present.reserve(static_cast<int>(snapshot.robots.size()));
+        for (const RobotPose& pose : snapshot.robots) {
+            RobotView* robotView = robotViews.value(pose.id, nullptr);
+            if (!robotView) {
+                robotView = new RobotView(engine, pose.id, nullptr);
+                scene->addItem(robotView);
+                robotViews.insert(pose.id, robotView);
+            }
+            robotView->setPosition(QPointF(pose.x, pose.y));
+            robotView->setOrientation(pose.orientation);
+            robotView->setSensorRange(pose.sensorRange);
+            robotView->setSpeed(pose.speed);
+            robotView->setHandle(pose.handle);
+            present.insert(pose.id);
+        }
+        for (auto it = robotViews.begin(); it != robotViews.end();) {
+            if (present.contains(it.key())) {
+                ++it;
+                continue;
+            }
+            scene->removeItem(it.value());
+            delete it.value();
+            it = robotViews.erase(it);
+        }
     }
 
-    auto obstacles = engine->getObstacles();
-    for (const auto& obstacle : obstacles) {
-        ObstacleView* obstacleView = new ObstacleView(engine, obstacle->getId(), obstacle->getBounds(), nullptr);
-        scene->addItem(obstacleView);
-        obstacleViews.insert(obstacle->getId(), obstacleView);
+    if (snapshot.obstacleRevision == drawnObstacleRevision) {
+        return;
+    }
+    drawnObstacleRevision = snapshot.obstacleRevision;
+    present.clear();
+    for (const ObstaclePose& pose : snapshot.obstacles) {
+        ObstacleView* obstacleView = obstacleViews.value(pose.id, nullptr);
+        if (!obstacleView) {
+            obstacleView = new ObstacleView(engine, pose.id, pose.bounds, nullptr);
+            scene->addItem(obstacleView);
+            obstacleViews.insert(pose.id, obstacleView);
+        } else {
+            obstacleView->setBounds(pose.bounds);
+        }
+        obstacleView->setHandle(pose.handle);
+        present.insert(pose.id);
+    }
+    for (auto it = obstacleViews.begin(); it != obstacleViews.end();) {
+        if (present.contains(it.key())) {
+            ++it;
+            continue;
+        }
+        scene->removeItem(it.value());
+        delete it.value();
+        it = obstacleViews.erase(it);
     }
-    scene->update();
 }
 
 /**
@@ -272,3 +319,74 @@ void SimulationWindow::stopSimulation() {
     engine->stop();
 }
 
+
+/**
+ * @brief Shows or hides the profiler overlay, switching the profiler on or off with it.
+ * @param visible True to record phase timings and show their percentiles over the view.
+ */
+void SimulationWindow::setProfilerOverlayVisible(bool visible) {
+    Profiler::setEnabled(visible);
+    profilerOverlay->setVisible(visible);
+    if (visible) {
+        Profiler::instance().reset();
+        collectProfile();
+    }
+    updateProfilerTimer();
+}
+
+/**
+ * @brief Starts recording a timeline trace, or stops it and asks where to save it.
+ * @param recording True to start a trace of the latest ticks, false to stop and save it.
+ */
+void SimulationWindow::setTraceRecording(bool recording) {
+    Profiler &profiler = Profiler::instance();
+    if (recording) {
+        profiler.startTrace(Profiler::TraceLimits());
+        updateProfilerTimer();
+        return;
+    }
+    profiler.stopTrace();
+    updateProfilerTimer();
+    QString path = QFileDialog::getSaveFileName(this, tr("Save trace"), QDir::homePath(), tr("Chrome traces (*.json)"));
+    std::string error;
+    if (!path.isEmpty() && !profiler.writeTrace(path.toStdString(), error)) {
+        QMessageBox::critical(this, tr("Error"), QString::fromStdString(error));
+    }
+}
+
+/**
+ * @brief Runs the profiler timer while the overlay is shown or a trace is recorded, more often for a trace.
+ */
+void SimulationWindow::updateProfilerTimer() {
+    if (Profiler::instance().tracing()) {
+        profilerTimer->start(traceCollectMs);
+    } else if (!profilerOverlay->isHidden()) {
+        profilerTimer->start(profilerRefreshMs);
+    } else {
+        profilerTimer->stop();
+    }
+}
+
+/**
+ * @brief Collects the spans recorded since the last call and, while the overlay is shown, redraws it with the p50,
+ * p95 and p99 latency of every phase, in microseconds.
+ */
+void SimulationWindow::collectProfile() {
+    Profiler &profiler = Profiler::instance();
+    profiler.collect();
+    if (profilerOverlay->isHidden()) {
+        return;
+    }
+    auto stats = profiler.statistics();
+    QString text = QString("%1 %2 %3 %4").arg("phase (us)", -13).arg("p50", 8).arg("p95", 8).arg("p99", 8);
+    for (size_t phase = 0; phase < stats.size(); ++phase) {
+        const Profiler::PhaseStats &entry = stats[phase];
+        if (entry.count == 0) {
+            continue;
+        }
+        text += QString("\n%1 %2 %3 %4").arg(Profiler::phaseName(static_cast<ProfilePhase>(phase)), -13)
+                .arg(entry.p50, 8, 'f', 1).arg(entry.p95, 8, 'f', 1).arg(entry.p99, 8, 'f', 1);
+    }
+    profilerOverlay->setText(text);
+    profilerOverlay->adjustSize();
+}
@@ -13,14 +13,20 @@
 #include "QFile"
 #include "QDebug"
 #include "QAction"
+#include "QSet"
 #include "QWidget"
 #include "QKeyEvent"
+#include "QLabel"
+#include "QTimer"
+#include "QFileDialog"
+#include "QMessageBox"
 #include "QVBoxLayout"
 #include "QTextStream"
 #include "QGraphicsView"
 #include "QGraphicsScene"
 #include "QContextMenuEvent"
 #include "RobotView.h"
+#include "FleetView.h"
 #include "RobotDialog.h"
 #include "ObstacleView.h"
 #include "ObstacleDialog.h"
@@ -43,6 +49,8 @@ public:
     void stopSimulation();
     void handleKeyPress(QKeyEvent *event);
     void handleKeyRelease(QKeyEvent *event);
+    void setProfilerOverlayVisible(bool visible);
+    void setTraceRecording(bool recording);
 
 protected:
     void contextMenuEvent(QContextMenuEvent *event) override;
@@ -54,9 +62,35 @@ private:
     SimulationEngine *engine;
     QMap<int, RobotView*> robotViews;
     QMap<int, ObstacleView*> obstacleViews;
+    FleetView *fleetView = nullptr; ///< Draws all robots while the fleet is larger than fleetThreshold, else nullptr.
+    unsigned long drawnObstacleRevision = 0; ///< Obstacle revision of the snapshot the obstacle views were last built from.
+    QLabel *profilerOverlay; ///< Latency percentiles of every phase, drawn over the top-left corner of the view.
+    QTimer *profilerTimer; ///< Collects profiler spans while the overlay is shown or a trace is recorded.
     QString lastAddedType;
     QString lastRobotType;
-    void modifyItem(QGraphicsItem* item);
+
+    /**
+     * @brief Robot or obstacle a context menu was opened on, copied out of its view.
+     */
+    struct MenuTarget {
+        enum Kind { None, Robot, Obstacle };
+        Kind kind = None; ///< What was clicked.
+        SlotHandle handle; ///< Handle of the entity in the engine.
+        int id = 0; ///< Identifier shown in the dialog.
+        double speed = 0; ///< Robot speed.
+        double orientation = 0; ///< Robot orientation in degrees.
+        double sensorRange = 0; ///< Robot sensor range.
+        double size = 0; ///< Obstacle size.
+        QPointF position; ///< Centre of the entity.
+    };
+
+    void modifyItem(const MenuTarget &target);
+    void collectProfile();
+    void updateProfilerTimer();
+
+    static constexpr size_t fleetThreshold = 2000; ///< Robot count above which the fleet is drawn as one item.
+    static constexpr int profilerRefreshMs = 500; ///< Interval between refreshes of the profiler overlay.
+    static constexpr int traceCollectMs = 100; ///< Interval between collections while a trace is recorded, short enough that rings rarely overflow.
 
     std::vector<std::unique_ptr<Robot>> robots;
 
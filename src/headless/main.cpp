@@ -0,0 +1,335 @@
+/**
+ * @file main.cpp
+ * @brief Entry point for the headless batch simulation runner.
+ *
+ * This file loads a configuration into an Environment, advances the SimulationEngine for a fixed number of ticks
+ * as fast as the CPU allows and writes the final state together with timing information. No QApplication, window or
+ * display server is needed, which makes it suitable for nightly scenario runs.
+ * @author Pavel Stepanov (xstepa77)
+ * @author Gleb Litvinchuk (xlitvi02)
+ * @date 2024-05-05
+ */
+
+#include "code/Environment.h"
+#include "code/SimulationEngine.h"
+#include "code/AutonomousRobot.h"
+#include "code/RemoteControlledRobot.h"
+#include "code/Logger.h"
+#include "chrono"
+#include "cstdlib"
+#include "cstring"
+#include "fstream"
+#include "iostream"
+#include "random"
+#include "string"
+#include "sstream"
+#include "vector"
+#include "algorithm"
+
+/**
+ * @brief Prints the command-line usage of the headless runner.
+ * @param program Name of the executable.
+ */
+static void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " [--ticks N] [--threads N] [--chunk N] [--sensor rays|sector] [--churn N] [--commands FILE] [--profile] [--trace FILE] [--trace-ticks N] [--log-level LEVEL] [--output FILE] CONFIG" << std::endl
+              << "  --ticks N      Number of simulation ticks to run (default 1000)." << std::endl
+              << "  --threads N    Update robots in parallel from a snapshot of the previous tick on N threads" << std::endl
+              << "                 (0 = all hardware threads). Results do not depend on N." << std::endl
+              << "  --chunk N      Robots per work-stealing chunk in parallel mode (default 16)." << std::endl
+              << "  --sensor MODE  Sensor test of autonomous robots: rays (default) or sector." << std::endl
+              << "  --churn N      Before every tick, remove N random robots and spawn each again in its place." << std::endl
+              << "  --commands FILE  Send the commands listed in FILE, one per line as TICK TARGET OPCODE [VALUE]," << std::endl
+              << "                 where TARGET is all, robot:ID or group:N." << std::endl
+              << "  --profile      Time the phases of every tick and append their latency percentiles to the output." << std::endl
+              << "  --trace FILE   Write a timeline of the run to FILE as Chrome trace-event JSON." << std::endl
+              << "  --trace-ticks N  Keep only the last N ticks in the trace (default 1000, 0 = all)." << std::endl
+              << "  --log-level LEVEL  Lowest level logged to stderr: debug, info (default), warning, error or off." << std::endl
+              << "  --output FILE  Write the final state and timing to FILE instead of stdout." << std::endl;
+}
+
+/**
+ * @brief Writes the final state of the environment in the configuration file format, followed by timing comments.
+ * @param out Stream to write into.
+ * @param environment Environment whose robots and obstacles are written.
+ * @param ticks Number of ticks that were simulated.
+ * @param elapsedSeconds Wall-clock time spent simulating.
+ * @param scheduler Scheduler of a parallel run whose per-worker load is reported, or nullptr.
+ *
+ * The output can be loaded back with Environment::loadConfiguration, since timing lines are written as comments.
+ */
+static void writeState(std::ostream& out, Environment& environment, long ticks, double elapsedSeconds, const TaskScheduler* scheduler) {
+    for (const auto& robot : environment.getRobots()) {
+        const char* type = robot->getKind() == RobotKind::Remote ? "remote" : "autonomous";
+        out << "Robot " << type << " " << robot->getID() << " "
+            << robot->getPosition().first << " " << robot->getPosition().second << " "
+            << robot->getSpeed() << " " << robot->getOrientation() << " " << robot->getSensorRange() << "\n";
+    }
+    for (const auto& obstacle : environment.getObstacles()) {
+        QRectF bounds = obstacle->getBounds();
+        out << "Obstacle " << obstacle->getId() << " "
+            << obstacle->getPosition().first << " " << obstacle->getPosition().second << " " << bounds.width() << "\n";
+    }
+
+    double ticksPerSecond = elapsedSeconds > 0 ? ticks / elapsedSeconds : 0.0;
+    double nsPerTick = ticks > 0 ? elapsedSeconds * 1e9 / ticks : 0.0;
+    out << "# robots: " << environment.getRobots().size() << "\n"
+        << "# obstacles: " << environment.getObstacles().size() << "\n"
+        << "# ticks: " << ticks << "\n"
+        << "# elapsed_s: " << elapsedSeconds << "\n"
+        << "# ticks_per_s: " << ticksPerSecond << "\n"
+        << "# ns_per_tick: " << nsPerTick << "\n";
+
+    if (scheduler) {
+        double schedulerSeconds = scheduler->getElapsedSeconds();
+        out << "# worker_utilization:";
+        for (const auto& worker : scheduler->getStats()) {
+            out << " " << (schedulerSeconds > 0 ? worker.busySeconds / schedulerSeconds : 0.0);
+        }
+        out << "\n# worker_chunks:";
+        for (const auto& worker : scheduler->getStats()) {
+            out << " " << worker.chunks;
+        }
+        out << "\n# worker_steals:";
+        for (const auto& worker : scheduler->getStats()) {
+            out << " " << worker.steals;
+        }
+        out << "\n";
+    }
+}
+
+/**
+ * @brief Removes random robots and spawns an identical new robot in place of each, to stress insertion and removal.
+ * @param environment Environment to churn.
+ * @param count Number of robots to replace.
+ * @param sensorMode Sensor mode given to respawned autonomous robots.
+ * @param random Random source; seeded the same on every run, so churned runs are reproducible.
+ */
+static void churnRobots(Environment& environment, long count, SensorMode sensorMode, std::mt19937& random) {
+    for (long i = 0; i < count && !environment.getRobots().empty(); ++i) {
+        auto& robots = environment.getRobots();
+        const Robot& robot = *robots[random() % robots.size()];
+        int id = robot.getID();
+        auto position = robot.getPosition();
+        double speed = robot.getSpeed();
+        double orientation = robot.getOrientation();
+        double sensorRange = robot.getSensorRange();
+        RobotKind kind = robot.getKind();
+
+        environment.removeRobot(id);
+        if (kind == RobotKind::Autonomous) {
+            auto respawned = std::make_unique<AutonomousRobot>(id, position, speed, orientation, sensorRange, environment.width, environment.height, &environment);
+            respawned->setSensorMode(sensorMode);
+            environment.addRobot(std::move(respawned));
+        } else {
+            environment.addRobot(std::make_unique<RemoteControlledRobot>(id, position, speed, orientation, sensorRange, &environment));
+        }
+    }
+}
+
+/**
+ * @brief A command of a command script, together with the tick before which it is sent.
+ */
+struct ScriptedCommand {
+    long tick; ///< Tick before which the command is sent.
+    RobotCommand command; ///< The command.
+};
+
+/**
+ * @brief Reads a command script.
+ * @param path Path of the script.
+ * @param script Receives the commands, ordered by tick and otherwise in file order.
+ * @return False if the file cannot be read or a line is malformed; the reason is printed to stderr.
+ *
+ * Each line holds TICK TARGET OPCODE [VALUE]. TARGET is all, robot:ID or group:N; OPCODE is one of
+ * start_move_forward, stop_move_forward, start_move_backward, stop_move_backward, start_turn_left, stop_turn_left,
+ * start_turn_right, stop_turn_right, set_speed and set_group. Empty lines and lines starting with # are skipped.
+ */
+static bool loadCommandScript(const std::string& path, std::vector<ScriptedCommand>& script) {
+    static const std::pair<const char*, CommandOpcode> opcodes[] = {
+        {"start_move_forward", CommandOpcode::StartMoveForward}, {"stop_move_forward", CommandOpcode::StopMoveForward},
+        {"start_move_backward", CommandOpcode::StartMoveBackward}, {"stop_move_backward", CommandOpcode::StopMoveBackward},
+        {"start_turn_left", CommandOpcode::StartTurnLeft}, {"stop_turn_left", CommandOpcode::StopTurnLeft},
+        {"start_turn_right", CommandOpcode::StartTurnRight}, {"stop_turn_right", CommandOpcode::StopTurnRight},
+        {"set_speed", CommandOpcode::SetSpeed}, {"set_group", CommandOpcode::SetGroup}
+    };
+
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        std::cerr << "Unable to open command script: " << path << std::endl;
+        return false;
+    }
+    std::string line;
+    for (int lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        if (line.empty() || line[0] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        ScriptedCommand entry{};
+        std::string target;
+        std::string opcode;
+        bool valid = static_cast<bool>(fields >> entry.tick >> target >> opcode) && entry.tick >= 0;
+        fields >> entry.command.value;
+
+        auto colon = target.find(':');
+        std::string targetKind = target.substr(0, colon);
+        if (valid && targetKind == "all" && colon == std::string::npos) {
+            entry.command.target = CommandTarget::All;
+        } else if (valid && (targetKind == "robot" || targetKind == "group") && colon != std::string::npos) {
+            entry.command.target = targetKind == "robot" ? CommandTarget::Robot : CommandTarget::Group;
+            char* parsedEnd = nullptr;
+            entry.command.targetId = static_cast<int>(std::strtol(target.c_str() + colon + 1, &parsedEnd, 10));
+            valid = parsedEnd != target.c_str() + colon + 1 && *parsedEnd == '\0';
+        } else {
+            valid = false;
+        }
+
+        auto known = std::find_if(std::begin(opcodes), std::end(opcodes), [&](const auto& candidate) { return opcode == candidate.first; });
+        if (!valid || known == std::end(opcodes)) {
+            std::cerr << path << ":" << lineNumber << ": malformed command: " << line << std::endl;
+            return false;
+        }
+        entry.command.opcode = known->second;
+        script.push_back(entry);
+    }
+    std::stable_sort(script.begin(), script.end(), [](const ScriptedCommand& a, const ScriptedCommand& b) { return a.tick < b.tick; });
+    return true;
+}
+
+/**
+ * @brief Main function of the headless runner.
+ * @param argc Number of command-line arguments.
+ * @param argv Array of command-line arguments.
+ * @return Zero on success, non-zero on invalid arguments or an unwritable output file.
+ */
+int main(int argc, char *argv[]) {
+    long ticks = 1000;
+    std::string outputPath;
+    std::string configPath;
+    std::string commandsPath;
+    SensorMode sensorMode = SensorMode::Rays;
+    int threads = -1;
+    int chunk = 0;
+    long churn = 0;
+    bool profile = false;
+    std::string tracePath;
+    Profiler::TraceLimits traceLimits;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            ticks = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--chunk") == 0 && i + 1 < argc) {
+            chunk = static_cast<int>(std::strtol(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--churn") == 0 && i + 1 < argc) {
+            churn = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--sensor") == 0 && i + 1 < argc) {
+            std::string mode = argv[++i];
+            if (mode != "rays" && mode != "sector") {
+                printUsage(argv[0]);
+                return 1;
+            }
+            sensorMode = mode == "sector" ? SensorMode::Sector : SensorMode::Rays;
+        } else if (std::strcmp(argv[i], "--commands") == 0 && i + 1 < argc) {
+            commandsPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--profile") == 0) {
+            profile = true;
+        } else if (std::strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            tracePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--trace-ticks") == 0 && i + 1 < argc) {
+            traceLimits.ticks = std::strtoul(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--log-level") == 0 && i + 1 < argc) {
+            LogLevel level;
+            if (!Logger::parseLevel(argv[++i], level)) {
+                printUsage(argv[0]);
+                return 1;
+            }
+            Logger::setLevel(level);
+        } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            outputPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--help") == 0 || std::strcmp(argv[i], "-h") == 0) {
+            printUsage(argv[0]);
+            return 0;
+        } else if (argv[i][0] != '-' && configPath.empty()) {
+            configPath = argv[i];
+        } else {
+            printUsage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (configPath.empty() || ticks < 0 || churn < 0) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    std::vector<ScriptedCommand> script;
+    if (!commandsPath.empty() && !loadCommandScript(commandsPath, script)) {
+        return 1;
+    }
+
+    bool trace = !tracePath.empty();
+    if ((profile || trace) && !Profiler::compiledIn) {
+        std::cerr << "Profiling was compiled out (ROBOT_SIM_PROFILING=0); --profile and --trace have no effect." << std::endl;
+    }
+    /// Switched on before loading, so the configuration load is timed as well.
+    Profiler::setThreadName("simulation");
+    Profiler::setEnabled(profile);
+    if (trace) {
+        Profiler::instance().startTrace(traceLimits);
+    }
+
+    Environment env;  /// Create an instance of Environment.
+    env.loadConfiguration(configPath);  /// Load configuration settings into the environment.
+    for (const auto& robot : env.getRobots()) {
+        if (robot->getKind() == RobotKind::Autonomous) {
+            static_cast<AutonomousRobot*>(robot.get())->setSensorMode(sensorMode);
+        }
+    }
+    SimulationEngine engine(&env);  /// The engine is only stepped manually, its timer is never started.
+    if (threads >= 0) {
+        engine.setUpdateMode(UpdateMode::Parallel, threads);
+    }
+    if (chunk > 0) {
+        engine.setChunkSize(chunk);
+    }
+
+    std::mt19937 random(1);
+    size_t nextCommand = 0;
+    auto begin = std::chrono::steady_clock::now();
+    for (long tick = 0; tick < ticks; ++tick) {
+        churnRobots(env, churn, sensorMode, random);
+        for (; nextCommand < script.size() && script[nextCommand].tick == tick; ++nextCommand) {
+            engine.sendCommand(script[nextCommand].command);
+        }
+        engine.step();
+        if (profile || trace) {
+            /// Drained every tick, so the per-thread rings cannot overflow however many chunks a tick has.
+            Profiler::instance().collect();
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+    double elapsedSeconds = std::chrono::duration<double>(end - begin).count();
+
+    std::ofstream file;
+    if (!outputPath.empty()) {
+        file.open(outputPath);
+        if (!file.is_open()) {
+            std::cerr << "Unable to open output file: " << outputPath << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = outputPath.empty() ? std::cout : file;
+    writeState(out, env, ticks, elapsedSeconds, engine.getScheduler());
+    if (profile) {
+        out << Profiler::instance().report("# ");
+    }
+    if (trace) {
+        Profiler::instance().stopTrace();
+        std::string error;
+        if (!Profiler::instance().writeTrace(tracePath, error)) {
+            std::cerr << error << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}